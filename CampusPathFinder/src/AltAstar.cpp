@@ -0,0 +1,297 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <random>
+#include <stdexcept>
+#include "ShortestPathBase.h"
+#include "AltAstar.h"
+
+namespace {
+
+using NodeId = Graph::NodeId;
+
+constexpr double kInfinity = std::numeric_limits<double>::infinity();
+
+// Full single-source Dijkstra; order receives nodes in settle order
+void distancesFrom(const Graph& graph, NodeId source, std::vector<double>& dist,
+                   std::vector<NodeId>& parent, std::vector<NodeId>& order) {
+    dist.assign(graph.nodeCount(), kInfinity);
+    parent.assign(graph.nodeCount(), Graph::kInvalidNode);
+    order.clear();
+
+    using Entry = std::pair<double, NodeId>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> pq;
+    dist[source] = 0.0;
+    pq.push({0.0, source});
+    while (!pq.empty()) {
+        auto [d, u] = pq.top();
+        pq.pop();
+        if (d > dist[u]) continue;
+        order.push_back(u);
+        for (Graph::Neighbor edge : graph.neighbors(u)) {
+            double nd = d + edge.weight;
+            if (nd < dist[edge.to]) {
+                dist[edge.to] = nd;
+                parent[edge.to] = u;
+                pq.push({nd, edge.to});
+            }
+        }
+    }
+}
+
+// Landmarks only help inside the component they live in, so they are all
+// placed in the largest one; queries elsewhere fall back to a zero potential.
+std::vector<NodeId> largestComponent(const Graph& graph) {
+    std::vector<NodeId> nodes;
+    if (graph.nodeCount() == 0) return nodes;
+    nodes.reserve(graph.componentSize(graph.largestComponent()));
+    for (NodeId v : graph.nodes()) {
+        if (graph.componentOf(v) == graph.largestComponent()) nodes.push_back(v);
+    }
+    return nodes;
+}
+
+class LandmarkBuilder {
+    public:
+        LandmarkBuilder(const Graph& graph, std::size_t count)
+            : graph(graph), component(largestComponent(graph)), rng(0xA17) {
+            landmarks = std::make_shared<AltAstar::Landmarks>();
+            landmarks->nodes.reserve(count);
+            minDist.assign(graph.nodeCount(), kInfinity);
+        }
+
+        void add(NodeId landmark) {
+            distancesFrom(graph, landmark, dist, parent, order);
+            landmarks->nodes.push_back(landmark);
+            rows.emplace_back(graph.nodeCount());
+            for (NodeId v : graph.nodes()) {
+                rows.back()[v] = dist[v] == kInfinity
+                    ? AltAstar::Landmarks::kUnreachable
+                    : static_cast<std::uint32_t>(std::floor(dist[v] / AltAstar::Landmarks::kResolution));
+                minDist[v] = std::min(minDist[v], dist[v]);
+            }
+        }
+
+        // Node of the main component whose nearest landmark is farthest away
+        NodeId farthest(NodeId from) const {
+            NodeId best = from;
+            for (NodeId v : component) {
+                if (minDist[v] != kInfinity && minDist[v] > minDist[best]) best = v;
+            }
+            return best;
+        }
+
+        // Avoid: grow a shortest-path tree from a random root, weight each node
+        // by how much the current landmarks underestimate its distance, and walk
+        // down into the heaviest subtree that holds no landmark yet.
+        NodeId avoid() {
+            NodeId root = component[rng() % component.size()];
+            distancesFrom(graph, root, dist, parent, order);
+
+            std::vector<double> slack(graph.nodeCount(), 0.0);
+            std::vector<bool> covered(graph.nodeCount(), false);
+            for (NodeId l : landmarks->nodes) covered[l] = true;
+            for (NodeId v : order) slack[v] = dist[v] - lowerBound(root, v);
+            for (auto it = order.rbegin(); it != order.rend(); ++it) {
+                NodeId v = *it;
+                NodeId p = parent[v];
+                if (covered[v]) slack[v] = 0.0;
+                if (p == Graph::kInvalidNode) continue;
+                slack[p] += slack[v];
+                if (covered[v]) covered[p] = true;
+            }
+
+            std::vector<NodeId> childOffsets(graph.nodeCount() + 1, 0), children(order.size());
+            for (NodeId v : order) {
+                if (parent[v] != Graph::kInvalidNode) childOffsets[parent[v] + 1]++;
+            }
+            for (std::size_t i = 1; i < childOffsets.size(); ++i) childOffsets[i] += childOffsets[i - 1];
+            std::vector<NodeId> fill(childOffsets.begin(), childOffsets.end() - 1);
+            for (NodeId v : order) {
+                if (parent[v] != Graph::kInvalidNode) children[fill[parent[v]]++] = v;
+            }
+
+            NodeId v = root;
+            while (true) {
+                NodeId next = Graph::kInvalidNode;
+                for (NodeId i = childOffsets[v]; i < childOffsets[v + 1]; ++i) {
+                    NodeId c = children[i];
+                    if (!covered[c] && (next == Graph::kInvalidNode || slack[c] > slack[next])) next = c;
+                }
+                if (next == Graph::kInvalidNode) break;
+                v = next;
+            }
+            return covered[v] ? farthest(root) : v;
+        }
+
+        std::shared_ptr<AltAstar::Landmarks> finish() {
+            const std::size_t k = rows.size();
+            landmarks->table.resize(graph.nodeCount() * k);
+            for (NodeId v : graph.nodes()) {
+                for (std::size_t i = 0; i < k; ++i) landmarks->table[std::size_t(v) * k + i] = rows[i][v];
+            }
+            return landmarks;
+        }
+
+        std::size_t size() const { return rows.size(); }
+        const std::vector<NodeId>& mainComponent() const { return component; }
+
+    private:
+        double lowerBound(NodeId a, NodeId b) const {
+            double best = 0.0;
+            for (const auto& row : rows) {
+                if (row[a] == AltAstar::Landmarks::kUnreachable || row[b] == AltAstar::Landmarks::kUnreachable) continue;
+                double diff = std::fabs(double(row[a]) - double(row[b])) * AltAstar::Landmarks::kResolution;
+                best = std::max(best, diff);
+            }
+            return best;
+        }
+
+        const Graph& graph;
+        std::vector<NodeId> component;
+        std::mt19937 rng;
+        std::shared_ptr<AltAstar::Landmarks> landmarks;
+        std::vector<std::vector<std::uint32_t>> rows;
+        std::vector<double> minDist;
+
+        std::vector<double> dist;
+        std::vector<NodeId> parent;
+        std::vector<NodeId> order;
+};
+
+} // namespace
+
+std::shared_ptr<const AltAstar::Landmarks> AltAstar::selectLandmarks(const Graph& graph, std::size_t count,
+                                                                     LandmarkSelection selection){
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    LandmarkBuilder builder(graph, count);
+    const auto& component = builder.mainComponent();
+    count = std::min(count, component.size());
+    if (count > 0) {
+        // Seed with the node farthest from an arbitrary start: a periphery node
+        std::vector<double> dist;
+        std::vector<NodeId> parent, order;
+        distancesFrom(graph, component.front(), dist, parent, order);
+        builder.add(order.back());
+    }
+    while (builder.size() < count) {
+        NodeId next = selection == LandmarkSelection::Farthest
+            ? builder.farthest(component.front())
+            : builder.avoid();
+        builder.add(next);
+    }
+
+    auto landmarks = builder.finish();
+    landmarks->buildMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - startTime).count();
+    return landmarks;
+}
+
+AltAstar::AltAstar(const std::string& filename, std::size_t landmarkCount)
+    : AltAstar(Graph::fromFile(filename), landmarkCount) {}
+
+AltAstar::AltAstar(std::shared_ptr<const Graph> graph, std::size_t landmarkCount)
+    : ShortestPathBase(std::move(graph)) {
+    landmarks = selectLandmarks(*this->graph, landmarkCount);
+}
+
+AltAstar::AltAstar(std::shared_ptr<const Graph> graph, std::shared_ptr<const Landmarks> landmarks)
+    : ShortestPathBase(std::move(graph)), landmarks(std::move(landmarks)) {
+    if (!this->landmarks || this->landmarks->table.size() != this->graph->nodeCount() * this->landmarks->count()) {
+        throw std::invalid_argument("AltAstar: landmarks do not match graph");
+    }
+}
+
+// Distances are rounded down to kResolution, so |a - b| may overshoot the true
+// difference by almost one unit; dropping that unit keeps the bound admissible.
+// A landmark that reaches exactly one of the two nodes proves they are disconnected.
+double AltAstar::potential(const std::uint32_t* from, const std::uint32_t* goal) const{
+    std::uint32_t best = 0;
+    for (std::size_t i = 0; i < landmarks->count(); ++i) {
+        std::uint32_t a = from[i];
+        std::uint32_t b = goal[i];
+        if (a == Landmarks::kUnreachable || b == Landmarks::kUnreachable) {
+            if (a != b) return kInfinity;
+            continue;
+        }
+        best = std::max(best, a > b ? a - b : b - a);
+    }
+    return best > 0 ? (best - 1) * Landmarks::kResolution : 0.0;
+}
+
+AltAstar::PathResult AltAstar::computePath(const Graph::EdgePoint& start, const Graph::EdgePoint& end,
+                                         Profile profile) const{
+    return computePathViaEdgeEnds(start, end, profile);
+}
+
+AltAstar::PathResult AltAstar::computePath(NodeId source, NodeId target, Profile profile) const{
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    PathResult result;
+    result.reachable = false;
+    result.weight = 0.0;
+    result.elapsedMs = 0.0;
+
+    if (source >= graph->nodeCount() || target >= graph->nodeCount()) {
+        return result; // edge check
+    }
+    if (!graph->connected(source, target)) {
+        return finish(result, startTime); // different components: nothing to search
+    }
+
+    auto scratch = scratchPool.acquire();
+    SearchWorkspace& workspace = scratch->workspace;
+    MinQueue& pq = scratch->pq;
+    Init(*scratch);
+
+    const std::uint32_t* goal = landmarks->row(target);
+    double h0 = potential(landmarks->row(source), goal);
+    if (h0 != kInfinity) {
+        workspace.update(source, 0, Graph::kInvalidNode);
+        pq.push(PQItem{h0, source});
+    }
+
+    // The rounding slack makes the potential admissible but not quite
+    // consistent, so a node may be reopened when a shorter route reaches it;
+    // an entry is stale once its f no longer matches the node's distance.
+    while(!pq.empty()){
+        PQItem cur = pq.top();
+        pq.pop();
+
+        NodeId removed = cur.second;
+        double g = workspace.distance(removed);
+        if (cur.first > g + potential(landmarks->row(removed), goal)) continue;
+        workspace.settle(removed);
+
+        if (removed == target) break;
+
+        for(Graph::Neighbor edge : graph->neighbors(removed, profile)){
+            NodeId next = edge.to;
+            double gScore = g + edge.weight;
+            if(gScore < workspace.distance(next)){
+                double hScore = potential(landmarks->row(next), goal);
+                if (hScore == kInfinity) continue;
+                workspace.update(next, gScore, removed);
+                pq.push(PQItem{gScore + hScore, next});
+            }
+        }
+    }
+
+    result.touchedNodes = workspace.stats().lastTouched;
+    result.settledNodes = workspace.stats().lastSettled;
+
+    if (workspace.distance(target) == kInfinity) {
+        return finish(result, startTime); //reachable = false
+    }
+
+    result.reachable = true;
+    result.path = buildPath(source, target, workspace);
+    result.weight = workspace.distance(target);
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    result.elapsedMs =
+        std::chrono::duration<double, std::milli>(endTime - startTime).count();
+    return result;
+}
@@ -0,0 +1,59 @@
+#ifndef ALTASTAR_H
+#define ALTASTAR_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Graph.h"
+#include "ShortestPathBase.h"
+
+// ALT: A* whose potential is the best triangle-inequality bound over a set of
+// precomputed landmarks, max_i |d(L_i, t) - d(L_i, v)|. The tables hold
+// walking meters; routing profiles only ever raise edge costs, so the same
+// landmarks bound every profile.
+class AltAstar : public ShortestPathBase {
+    public:
+        enum class LandmarkSelection {
+            Farthest, // each landmark maximizes its distance to those already chosen
+            Avoid,    // Goldberg-Werneck: grow landmarks where current bounds are weakest
+        };
+
+        // Landmark distance tables, node-major (a node's K distances share a cache line)
+        // in kResolution units rounded down; kUnreachable marks another component.
+        struct Landmarks {
+            static constexpr double kResolution = 0.01; // meters per unit
+            static constexpr std::uint32_t kUnreachable = 0xFFFFFFFFu;
+
+            std::vector<Graph::NodeId> nodes;
+            std::vector<std::uint32_t> table;
+            double buildMs = 0.0;
+
+            std::size_t count() const { return nodes.size(); }
+            std::size_t bytes() const { return table.size() * sizeof(std::uint32_t); }
+            const std::uint32_t* row(Graph::NodeId v) const { return table.data() + std::size_t(v) * nodes.size(); }
+        };
+
+        static constexpr std::size_t kDefaultLandmarks = 8;
+
+        static std::shared_ptr<const Landmarks> selectLandmarks(const Graph& graph, std::size_t count,
+                                                                LandmarkSelection selection = LandmarkSelection::Avoid);
+
+        explicit AltAstar(const std::string& filename, std::size_t landmarkCount = kDefaultLandmarks);
+        explicit AltAstar(std::shared_ptr<const Graph> graph, std::size_t landmarkCount = kDefaultLandmarks);
+        AltAstar(std::shared_ptr<const Graph> graph, std::shared_ptr<const Landmarks> landmarks);
+        using ShortestPathBase::computePath;
+        PathResult computePath(NodeId source, NodeId target, Profile profile) const override;
+        // Edge points (and so coordinates) too: one landmark search per pair of edge ends
+        PathResult computePath(const Graph::EdgePoint& start, const Graph::EdgePoint& end,
+                               Profile profile = Profile::Walking) const override;
+
+        const std::shared_ptr<const Landmarks>& sharedLandmarks() const { return landmarks; }
+
+    private:
+        double potential(const std::uint32_t* from, const std::uint32_t* goal) const;
+
+        std::shared_ptr<const Landmarks> landmarks;
+};
+
+#endif
@@ -1,29 +1,22 @@
 #include "ShortestPathBase.h"
 #include "Astar.h"
+#include "GeoBatch.h"
 
-Astar::Astar(const std::string& filename){
-     graph.loadFromFile(filename);
-     Init();
- }
-
-double Astar::deg2rad(double deg) {
-    return deg * M_PI / 180.0;
+namespace {
+// Nodes with at least this many edges get all their chord estimates from one SIMD batch
+constexpr std::size_t kBatchDegree = 4;
 }
 
-// Haversine distance between two points (lat/lon in degrees)
-double Astar::haversine(double lat1, double lon1, double lat2, double lon2) {
-    double dLat = deg2rad(lat2 - lat1);
-    double dLon = deg2rad(lon2 - lon1);
-
-    double a = std::sin(dLat/2) * std::sin(dLat/2) +
-               std::cos(deg2rad(lat1)) * std::cos(deg2rad(lat2)) *
-               std::sin(dLon/2) * std::sin(dLon/2);
+template <typename Queue>
+BasicAstar<Queue>::BasicAstar(const std::string& filename, AstarHeuristic heuristic)
+    : ShortestPathBase(Graph::fromFile(filename)), heuristic(heuristic) {}
 
-    double c = 2 * std::atan2(std::sqrt(a), std::sqrt(1-a));
-    return kEarthRadius * c;
-}
+template <typename Queue>
+BasicAstar<Queue>::BasicAstar(std::shared_ptr<const Graph> graph, AstarHeuristic heuristic)
+    : ShortestPathBase(std::move(graph)), heuristic(heuristic) {}
 
-Astar::PathResult Astar::computePath(const std::string& start, const std::string& end){
+template <typename Queue>
+typename BasicAstar<Queue>::PathResult BasicAstar<Queue>::computePath(NodeId source, NodeId target, Profile profile) const{
     auto startTime = std::chrono::high_resolution_clock::now();
 
     PathResult result;
@@ -31,75 +24,102 @@ Astar::PathResult Astar::computePath(const std::string& start, const std::string
     result.weight = 0.0;
     result.elapsedMs = 0.0;
     
-    if (!graph.containsNode(start) || !graph.containsNode(end)) {
+    if (source >= graph->nodeCount() || target >= graph->nodeCount()) {
         return result; // edge check
     }
+    if (!graph->connected(source, target)) {
+        return finish(result, startTime); // different components: nothing to search
+    }
 
-    Init();  //Resets member variables in the case the program has ran before
-    
-    dist[start] = 0;
+    auto scratch = queuePool.acquire();
+    SearchWorkspace& workspace = scratch->workspace;
+    Queue& queue = scratch->queue;
+    std::vector<double>& estimates = scratch->estimates;
+    workspace.prepare(graph->nodeCount());  //Fresh generation; this call's scratch is private to it
+    queue.reset(graph->nodeCount());
     
-    double h0 = haversine(
-        graph.getNodeLocation(start).lat,
-        graph.getNodeLocation(start).lon,
-        graph.getNodeLocation(end).lat,
-        graph.getNodeLocation(end).lon
-    );
-
-    pq.push(PQItem{h0, start}); // f = 0 + h(start)
+    workspace.update(source, 0, Graph::kInvalidNode);
+
+    // Target-side terms are fetched once; per edge only the neighbor's cached point is read
+    const Geo::Point& goal = graph->geoPoint(target);
+    const bool chord = heuristic == AstarHeuristic::Chord;
+    auto estimate = [&](NodeId v) {
+        return chord ? Geo::chord(graph->geoPoint(v), goal) : Geo::greatCircle(graph->geoPoint(v), goal);
+    };
+    double h0 = estimate(source);
+
+    queue.push(PQItem{h0, source}); // f = 0 + h(start)
     
-    while(!pq.empty()){
-        PQItem cur = pq.top();
-        pq.pop();
+    while(!queue.empty()){
+        PQItem cur = queue.top();
+        queue.pop();
 
-        std::string removed = cur.second;
+        NodeId removed = cur.second;
 
-        if (visited[removed]) continue;
-        visited[removed] = true;
+        if (workspace.isSettled(removed)) {
+            queue.countStale(); // only lazy queues leave these behind
+            continue;
+        }
+        workspace.settle(removed);
 
-        if (removed == end) break;
+        if (removed == target) break;
         
-        for(auto& edge : graph.getNeighbors(removed)){
-            if(visited[edge.first]) continue;
+        auto edges = graph->neighbors(removed, profile);
+        const double* batch = nullptr;
+        if (chord && edges.size() >= kBatchDegree) {
+            estimates.resize(edges.size());
+            GeoBatch::chordDistances(graph->geoPoints().data(), graph->neighborIds(removed).data(),
+                                     edges.size(), goal, estimates.data());
+            batch = estimates.data();
+        }
+
+        std::size_t slot = 0;
+        for(Graph::Neighbor edge : edges){
+            NodeId next = edge.to;
+            const std::size_t k = slot++;
+            if(workspace.isSettled(next)) continue;
         
-            double hScore = haversine(
-                graph.getNodeLocation(edge.first).lat,
-                graph.getNodeLocation(edge.first).lon,
-                graph.getNodeLocation(end).lat,
-                graph.getNodeLocation(end).lon
-            );
-            double gScore = dist[removed] + edge.second;
-            double fScore = gScore + hScore;
+            double gScore = workspace.distance(removed) + edge.weight;
         
-            if(gScore < dist[edge.first]){
-                dist[edge.first] = gScore;
-                prev[edge.first] = removed;
-                pq.push(PQItem{fScore, edge.first});
+            if(gScore < workspace.distance(next)){
+                workspace.update(next, gScore, removed); // only improving edges pay for the estimate
+                queue.push(PQItem{gScore + (batch ? batch[k] : estimate(next)), next});
             }
         }
     }
     
-    if (dist[end] == std::numeric_limits<double>::infinity()) {
-        return result; //reachable = false
-    }
-    
-    std::vector<std::string> forwardPath;
+    result.touchedNodes = workspace.stats().lastTouched;
+    result.settledNodes = workspace.stats().lastSettled;
 
-    std::string traversal = end;
-
-    while(traversal != start){
-        forwardPath.push_back(traversal);
-        traversal = prev.at(traversal);
+    if (workspace.distance(target) == std::numeric_limits<double>::infinity()) {
+        return finish(result, startTime); //reachable = false
     }
-    forwardPath.push_back(start);
     
-    std::reverse(forwardPath.begin(),forwardPath.end());
     result.reachable = true;
-    result.path = forwardPath;
-    result.weight = dist[end];
+    result.path = buildPath(source, target, workspace);
+    result.weight = workspace.distance(target);
     
     auto endTime = std::chrono::high_resolution_clock::now();
     result.elapsedMs =
         std::chrono::duration<double, std::milli>(endTime - startTime).count();
     return result;
 }
+
+template <typename Queue>
+SearchWorkspace::Stats BasicAstar<Queue>::workspaceStats() const{
+    SearchWorkspace::Stats total;
+    queuePool.forEachIdle([&](const QueueScratch& scratch) { addStats(total, scratch.workspace); });
+    return total;
+}
+
+template <typename Queue>
+QueueStats BasicAstar<Queue>::queueStats() const{
+    QueueStats total;
+    queuePool.forEachIdle([&](const QueueScratch& scratch) { total += scratch.queue.stats(); });
+    return total;
+}
+
+template class BasicAstar<BinaryHeapQueue>;
+template class BasicAstar<QuaternaryHeapQueue>;
+template class BasicAstar<RadixHeapQueue>;
+template class BasicAstar<PairingHeapQueue>;
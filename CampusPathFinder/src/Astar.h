@@ -2,19 +2,44 @@
 #define ASTAR_H
 #include <cmath>
 #include "Graph.h"
+#include "PriorityQueues.h"
 #include "ShortestPathBase.h"
 
 
-class Astar : public ShortestPathBase {
+// Lower bounds on the remaining walk, both read from the graph's cached
+// per-node trigonometry. Chord is a square root per edge; GreatCircle is the
+// exact haversine distance (sin, sqrt, asin) and prunes marginally more.
+enum class AstarHeuristic { Chord, GreatCircle };
+
+// Queue is one of the policies in PriorityQueues.h; the instantiations live in Astar.cpp.
+template <typename Queue>
+class BasicAstar : public ShortestPathBase {
     public:
-        const double kEarthRadius = 6371000; // meters
+        static constexpr double kEarthRadius = Geo::kEarthRadius; // meters
+
+        explicit BasicAstar(const std::string& filename, AstarHeuristic heuristic = AstarHeuristic::Chord);
+        explicit BasicAstar(std::shared_ptr<const Graph> graph, AstarHeuristic heuristic = AstarHeuristic::Chord);
+        using ShortestPathBase::computePath;
+        PathResult computePath(NodeId source, NodeId target, Profile profile) const override;
 
-        explicit Astar(const std::string& filename);
-        PathResult computePath(const std::string& start, const std::string& end) override;
+        SearchWorkspace::Stats workspaceStats() const override;
+        QueueStats queueStats() const; // totals over idle scratch, like workspaceStats()
     private:
-        double deg2rad(double deg);
-        double haversine(double lat1, double lon1, double lat2, double lon2);
-        
+        AstarHeuristic heuristic;
+
+        struct QueueScratch {
+            SearchWorkspace workspace;
+            Queue queue;
+            std::vector<double> estimates; // batch heuristic values for one high-degree node
+        };
+        ScratchPool<QueueScratch> queuePool;
 };
 
+extern template class BasicAstar<BinaryHeapQueue>;
+extern template class BasicAstar<QuaternaryHeapQueue>;
+extern template class BasicAstar<RadixHeapQueue>;
+extern template class BasicAstar<PairingHeapQueue>;
+
+using Astar = BasicAstar<BinaryHeapQueue>;
+
 #endif
@@ -0,0 +1,11 @@
+#include "BidirectionalAstar.h"
+
+BidirectionalAstar::BidirectionalAstar(const std::string& filename)
+    : BidirectionalDijkstra(filename) {}
+
+BidirectionalAstar::BidirectionalAstar(std::shared_ptr<const Graph> graph)
+    : BidirectionalDijkstra(std::move(graph)) {}
+
+BidirectionalAstar::PathResult BidirectionalAstar::computePath(NodeId source, NodeId target, Profile profile) const{
+    return search(source, target, profile, true);
+}
@@ -0,0 +1,17 @@
+#ifndef BIDIRECTIONALASTAR_H
+#define BIDIRECTIONALASTAR_H
+
+#include "Graph.h"
+#include "BidirectionalDijkstra.h"
+
+// Bidirectional A* with consistent average potentials:
+// p_f(v) = (h_t(v) - h_s(v)) / 2 forward and p_b(v) = -p_f(v) backward.
+class BidirectionalAstar : public BidirectionalDijkstra {
+    public:
+        explicit BidirectionalAstar(const std::string& filename);
+        explicit BidirectionalAstar(std::shared_ptr<const Graph> graph);
+        using ShortestPathBase::computePath;
+        PathResult computePath(NodeId source, NodeId target, Profile profile) const override;
+};
+
+#endif
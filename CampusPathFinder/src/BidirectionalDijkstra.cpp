@@ -0,0 +1,122 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "ShortestPathBase.h"
+#include "BidirectionalDijkstra.h"
+
+BidirectionalDijkstra::BidirectionalDijkstra(const std::string& filename)
+    : ShortestPathBase(Graph::fromFile(filename)) {}
+
+BidirectionalDijkstra::BidirectionalDijkstra(std::shared_ptr<const Graph> graph)
+    : ShortestPathBase(std::move(graph)) {}
+
+BidirectionalDijkstra::PathResult BidirectionalDijkstra::computePath(NodeId source, NodeId target, Profile profile) const{
+    return search(source, target, profile, false);
+}
+
+BidirectionalDijkstra::PathResult BidirectionalDijkstra::search(NodeId source, NodeId target, Profile profile, bool goalDirected) const{
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    PathResult result;
+    result.reachable = false;
+    result.weight = 0.0;
+    result.elapsedMs = 0.0;
+
+    if (source >= graph->nodeCount() || target >= graph->nodeCount()) {
+        return result; // edge check
+    }
+    if (!graph->connected(source, target)) {
+        return finish(result, startTime); // different components: nothing to search
+    }
+
+    auto scratch = scratchPool.acquire();
+    SearchWorkspace& workspace = scratch->workspace;
+    SearchWorkspace& backward = scratch->backward;
+    MinQueue& pq = scratch->pq;
+    MinQueue& backwardPq = scratch->backwardPq;
+
+    Init(*scratch);  //Fresh generation for the forward side
+    backward.prepare(graph->nodeCount());
+    while (!backwardPq.empty()) backwardPq.pop();
+
+    const Geo::Point& from = graph->geoPoint(source);
+    const Geo::Point& to = graph->geoPoint(target);
+
+    // Forward potential p_f(v); the backward search uses -p_f(v). Zero for plain Dijkstra.
+    // Chord bounds are consistent, so their average keeps both sides' reduced costs non-negative.
+    auto potential = [&](NodeId v) {
+        if (!goalDirected) return 0.0;
+        const Geo::Point& at = graph->geoPoint(v);
+        return 0.5 * (Geo::chord(at, to) - Geo::chord(at, from));
+    };
+
+    workspace.update(source, 0, Graph::kInvalidNode);
+    backward.update(target, 0, Graph::kInvalidNode);
+    pq.push(PQItem{potential(source), source});
+    backwardPq.push(PQItem{-potential(target), target});
+
+    double best = std::numeric_limits<double>::infinity(); // shortest s-t distance seen so far
+    NodeId meet = Graph::kInvalidNode;
+    if (source == target) {
+        best = 0.0;
+        meet = source;
+    }
+
+    while(!pq.empty() && !backwardPq.empty()){
+        // With p_b = -p_f the potentials cancel, so this is the plain bidirectional bound
+        if (pq.top().first + backwardPq.top().first >= best) break;
+
+        // Expand the smaller frontier
+        bool forwardTurn = pq.size() <= backwardPq.size();
+        auto& queue = forwardTurn ? pq : backwardPq;
+        SearchWorkspace& self = forwardTurn ? workspace : backward;
+        const SearchWorkspace& other = forwardTurn ? backward : workspace;
+        const double sign = forwardTurn ? 1.0 : -1.0;
+
+        NodeId removed = queue.top().second;
+        queue.pop();
+
+        if (self.isSettled(removed)) continue;
+        self.settle(removed);
+
+        double removed_dist = self.distance(removed);
+
+        for(Graph::Neighbor edge : graph->neighbors(removed, profile)){
+            NodeId next = edge.to;
+            if(self.isSettled(next)) continue;
+            double newDist = removed_dist + edge.weight;
+            if(newDist < self.distance(next)){
+                self.update(next, newDist, removed);
+                queue.push(PQItem{newDist + sign * potential(next), next});
+
+                double through = newDist + other.distance(next);
+                if (through < best) {
+                    best = through;
+                    meet = next;
+                }
+            }
+        }
+    }
+
+    result.touchedNodes = workspace.stats().lastTouched + backward.stats().lastTouched;
+    result.settledNodes = workspace.stats().lastSettled + backward.stats().lastSettled;
+
+    if (meet == Graph::kInvalidNode) {
+        return finish(result, startTime); //reachable = false
+    }
+
+    // source..meet from the forward tree, then meet..target from the backward tree
+    std::vector<std::string> forwardPath = buildPath(source, meet, workspace);
+    std::vector<std::string> backwardPath = buildPath(target, meet, backward);
+    std::reverse(backwardPath.begin(), backwardPath.end());
+    forwardPath.insert(forwardPath.end(), backwardPath.begin() + 1, backwardPath.end());
+
+    result.reachable = true;
+    result.path = std::move(forwardPath);
+    result.weight = best;
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    result.elapsedMs =
+        std::chrono::duration<double, std::milli>(endTime - startTime).count();
+    return result;
+}
@@ -0,0 +1,22 @@
+#ifndef BIDIRECTIONALDIJKSTRA_H
+#define BIDIRECTIONALDIJKSTRA_H
+
+#include "Graph.h"
+#include "ShortestPathBase.h"
+
+// Runs Dijkstra from both endpoints at once. The graph is undirected, so the
+// backward search walks the same adjacency. Stops once the two queue minima
+// together can no longer beat the best meeting distance found so far.
+class BidirectionalDijkstra : public ShortestPathBase {
+    public:
+        explicit BidirectionalDijkstra(const std::string& filename);
+        explicit BidirectionalDijkstra(std::shared_ptr<const Graph> graph);
+        using ShortestPathBase::computePath;
+        PathResult computePath(NodeId source, NodeId target, Profile profile) const override;
+
+    protected:
+        // goalDirected = true switches both searches to the average A* potentials
+        PathResult search(NodeId source, NodeId target, Profile profile, bool goalDirected) const;
+};
+
+#endif
@@ -0,0 +1,460 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include "Checksum.h"
+#include "ShortestPathBase.h"
+#include "ContractionHierarchy.h"
+
+namespace {
+
+using NodeId = Graph::NodeId;
+
+constexpr double kInfinity = std::numeric_limits<double>::infinity();
+constexpr std::size_t kWitnessSettleLimit = 500; // giving up early only costs an extra shortcut
+
+// Offline contraction over a mutable copy of the graph's adjacency
+class Contractor {
+    public:
+        Contractor(const Graph& graph, Graph::Profile profile)
+            : adj(graph.nodeCount()), up(graph.nodeCount()),
+              contracted(graph.nodeCount(), false),
+              contractedNeighbors(graph.nodeCount(), 0), level(graph.nodeCount(), 0) {
+            for (NodeId u : graph.nodes()) {
+                for (Graph::Neighbor edge : graph.neighbors(u, profile)) {
+                    if (edge.to != u && !std::isinf(edge.weight)) addArc(u, edge.to, edge.weight, Graph::kInvalidNode);
+                }
+            }
+        }
+
+        std::shared_ptr<ContractionHierarchy::Hierarchy> run() {
+            auto hierarchy = std::make_shared<ContractionHierarchy::Hierarchy>();
+            const std::size_t n = adj.size();
+            hierarchy->rank.assign(n, 0);
+
+            using Entry = std::pair<long long, NodeId>;
+            std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> order;
+            for (NodeId v = 0; v < n; ++v) order.push({priority(v), v});
+
+            std::uint32_t nextRank = 0;
+            while (!order.empty()) {
+                NodeId v = order.top().second;
+                order.pop();
+                if (contracted[v]) continue;
+
+                // Lazy update: priorities drift as neighbors get contracted
+                long long current = priority(v);
+                if (!order.empty() && current > order.top().first) {
+                    order.push({current, v});
+                    continue;
+                }
+
+                contract(v);
+                hierarchy->rank[v] = nextRank++;
+            }
+
+            // Freeze the upward edges into CSR form
+            hierarchy->upOffsets.assign(n + 1, 0);
+            for (NodeId v = 0; v < n; ++v) hierarchy->upOffsets[v + 1] = hierarchy->upOffsets[v] + up[v].size();
+            for (NodeId v = 0; v < n; ++v) {
+                for (const Arc& arc : up[v]) {
+                    hierarchy->upTargets.push_back(arc.to);
+                    hierarchy->upWeights.push_back(arc.weight);
+                    hierarchy->upMiddle.push_back(arc.middle);
+                    if (arc.middle != Graph::kInvalidNode) hierarchy->shortcuts++;
+                }
+            }
+            return hierarchy;
+        }
+
+    private:
+        struct Arc {
+            NodeId to;
+            double weight;
+            NodeId middle;
+        };
+        struct Shortcut {
+            NodeId from;
+            NodeId to;
+            double weight;
+        };
+
+        // Adds a->b or lowers an existing a->b arc; parallel edges collapse to the shortest
+        void addArc(NodeId a, NodeId b, double weight, NodeId middle) {
+            for (Arc& arc : adj[a]) {
+                if (arc.to == b) {
+                    if (weight < arc.weight) arc = {b, weight, middle};
+                    return;
+                }
+            }
+            adj[a].push_back({b, weight, middle});
+        }
+
+        // Shortest distances from source avoiding skip, bounded by limit
+        void witnessSearch(NodeId source, NodeId skip, double limit) {
+            witness.prepare(adj.size());
+            while (!heap.empty()) heap.pop();
+
+            witness.update(source, 0, Graph::kInvalidNode);
+            heap.push({0.0, source});
+            std::size_t settled = 0;
+
+            while (!heap.empty()) {
+                auto [d, u] = heap.top();
+                heap.pop();
+                if (witness.isSettled(u)) continue;
+                if (d > limit || ++settled > kWitnessSettleLimit) break;
+                witness.settle(u);
+
+                for (const Arc& arc : adj[u]) {
+                    if (arc.to == skip) continue;
+                    double nd = d + arc.weight;
+                    if (nd < witness.distance(arc.to)) {
+                        witness.update(arc.to, nd, u);
+                        heap.push({nd, arc.to});
+                    }
+                }
+            }
+        }
+
+        // Shortcuts contracting v would need: pairs of neighbors with no witness path as short as via v
+        void findShortcuts(NodeId v, std::vector<Shortcut>& out) {
+            out.clear();
+            const std::vector<Arc>& arcs = adj[v];
+            double maxArc = 0.0;
+            for (const Arc& arc : arcs) maxArc = std::max(maxArc, arc.weight);
+
+            for (std::size_t i = 0; i + 1 < arcs.size(); ++i) {
+                witnessSearch(arcs[i].to, v, arcs[i].weight + maxArc);
+                for (std::size_t j = i + 1; j < arcs.size(); ++j) {
+                    double via = arcs[i].weight + arcs[j].weight;
+                    if (witness.distance(arcs[j].to) > via) {
+                        out.push_back({arcs[i].to, arcs[j].to, via});
+                    }
+                }
+            }
+        }
+
+        // Edge difference, plus terms that spread contraction evenly and keep the hierarchy shallow
+        long long priority(NodeId v) {
+            findShortcuts(v, scratch);
+            long long edgeDifference = static_cast<long long>(scratch.size()) - static_cast<long long>(adj[v].size());
+            return 2 * edgeDifference + contractedNeighbors[v] + level[v];
+        }
+
+        void contract(NodeId v) {
+            findShortcuts(v, scratch);
+            for (const Shortcut& sc : scratch) {
+                addArc(sc.from, sc.to, sc.weight, v);
+                addArc(sc.to, sc.from, sc.weight, v);
+            }
+
+            // Every remaining neighbor is contracted later, so all of v's arcs point upward
+            up[v] = std::move(adj[v]);
+            adj[v].clear();
+            for (const Arc& arc : up[v]) {
+                auto& list = adj[arc.to];
+                list.erase(std::remove_if(list.begin(), list.end(),
+                                          [v](const Arc& back) { return back.to == v; }),
+                           list.end());
+                contractedNeighbors[arc.to]++;
+                level[arc.to] = std::max(level[arc.to], level[v] + 1);
+            }
+            contracted[v] = true;
+        }
+
+        std::vector<std::vector<Arc>> adj;
+        std::vector<std::vector<Arc>> up;
+        std::vector<bool> contracted;
+        std::vector<int> contractedNeighbors;
+        std::vector<int> level;
+        std::vector<Shortcut> scratch;
+
+        SearchWorkspace witness;
+        using HeapItem = std::pair<double, NodeId>;
+        std::priority_queue<HeapItem, std::vector<HeapItem>, std::greater<HeapItem>> heap;
+};
+
+// Identifies the graph a hierarchy was built for (node keys + adjacency under the profile's costs)
+std::uint64_t graphFingerprint(const Graph& graph, Graph::Profile profile) {
+    std::uint64_t h = fnv1a(nullptr, 0);
+    for (NodeId u : graph.nodes()) {
+        Graph::NodeKey key = graph.nodeKey(u);
+        h = fnv1a(&key, sizeof(key), h);
+        auto ids = graph.neighborIds(u);
+        auto weights = graph.neighborWeights(u, profile);
+        h = fnv1a(ids.data(), ids.size_bytes(), h);
+        h = fnv1a(weights.data(), weights.size_bytes(), h);
+    }
+    return h;
+}
+
+constexpr char kMagic[8] = {'C', 'P', 'F', 'C', 'H', '\0', '\0', '\0'};
+constexpr std::uint32_t kVersion = 1;
+
+struct FileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t profile; // RoutingProfile::Profile
+    std::uint64_t nodeCount;
+    std::uint64_t upEdgeCount;
+    std::uint64_t shortcuts;
+    std::uint64_t graphFingerprint;
+    std::uint64_t payloadChecksum;
+};
+
+} // namespace
+
+std::shared_ptr<const ContractionHierarchy::Hierarchy> ContractionHierarchy::preprocess(const Graph& graph, Graph::Profile profile){
+    auto startTime = std::chrono::high_resolution_clock::now();
+    Contractor contractor(graph, profile);
+    auto hierarchy = contractor.run();
+    hierarchy->profile = profile;
+    hierarchy->buildMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - startTime).count();
+    return hierarchy;
+}
+
+void ContractionHierarchy::Hierarchy::save(const std::string& filename, const Graph& graph) const {
+    auto bytesOf = [](const auto& v) { return v.size() * sizeof(v[0]); };
+
+    FileHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.nodeCount = rank.size();
+    header.upEdgeCount = upTargets.size();
+    header.shortcuts = shortcuts;
+    header.profile = static_cast<std::uint32_t>(profile);
+    header.graphFingerprint = graphFingerprint(graph, profile);
+
+    std::uint64_t h = fnv1a(rank.data(), bytesOf(rank));
+    h = fnv1a(upOffsets.data(), bytesOf(upOffsets), h);
+    h = fnv1a(upTargets.data(), bytesOf(upTargets), h);
+    h = fnv1a(upWeights.data(), bytesOf(upWeights), h);
+    h = fnv1a(upMiddle.data(), bytesOf(upMiddle), h);
+    header.payloadChecksum = h;
+
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        throw std::runtime_error("Could not open file for writing: " + filename);
+    }
+    auto write = [&](const void* data, std::size_t bytes) {
+        out.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+    };
+    write(&header, sizeof(header));
+    write(rank.data(), bytesOf(rank));
+    write(upOffsets.data(), bytesOf(upOffsets));
+    write(upTargets.data(), bytesOf(upTargets));
+    write(upWeights.data(), bytesOf(upWeights));
+    write(upMiddle.data(), bytesOf(upMiddle));
+    if (!out) {
+        throw std::runtime_error("Failed writing hierarchy: " + filename);
+    }
+}
+
+std::shared_ptr<const ContractionHierarchy::Hierarchy>
+ContractionHierarchy::Hierarchy::load(const std::string& filename, const Graph& graph){
+    std::ifstream in(filename, std::ios::binary);
+    if (!in.is_open()) {
+        throw std::runtime_error("Could not open file: " + filename);
+    }
+    auto fail = [&](const std::string& why) {
+        throw std::runtime_error("Invalid hierarchy (" + why + "): " + filename);
+    };
+
+    FileHeader header{};
+    in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!in || std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) fail("bad magic");
+    if (header.version != kVersion) fail("unsupported version " + std::to_string(header.version));
+    if (header.profile >= RoutingProfile::kCount) fail("unknown profile " + std::to_string(header.profile));
+    const auto profile = static_cast<Graph::Profile>(header.profile);
+    if (header.nodeCount != graph.nodeCount() || header.graphFingerprint != graphFingerprint(graph, profile)) {
+        fail("built for a different graph");
+    }
+
+    auto hierarchy = std::make_shared<Hierarchy>();
+    hierarchy->profile = profile;
+    auto read = [&](auto& v, std::size_t count) {
+        v.resize(count);
+        in.read(reinterpret_cast<char*>(v.data()), static_cast<std::streamsize>(count * sizeof(v[0])));
+        if (!in) fail("truncated");
+    };
+    read(hierarchy->rank, header.nodeCount);
+    read(hierarchy->upOffsets, header.nodeCount + 1);
+    read(hierarchy->upTargets, header.upEdgeCount);
+    read(hierarchy->upWeights, header.upEdgeCount);
+    read(hierarchy->upMiddle, header.upEdgeCount);
+    hierarchy->shortcuts = header.shortcuts;
+
+    auto bytesOf = [](const auto& v) { return v.size() * sizeof(v[0]); };
+    std::uint64_t h = fnv1a(hierarchy->rank.data(), bytesOf(hierarchy->rank));
+    h = fnv1a(hierarchy->upOffsets.data(), bytesOf(hierarchy->upOffsets), h);
+    h = fnv1a(hierarchy->upTargets.data(), bytesOf(hierarchy->upTargets), h);
+    h = fnv1a(hierarchy->upWeights.data(), bytesOf(hierarchy->upWeights), h);
+    h = fnv1a(hierarchy->upMiddle.data(), bytesOf(hierarchy->upMiddle), h);
+    if (h != header.payloadChecksum) fail("checksum");
+    if (hierarchy->upOffsets.back() != header.upEdgeCount) fail("upward offsets");
+
+    return hierarchy;
+}
+
+ContractionHierarchy::ContractionHierarchy(const std::string& filename)
+    : ContractionHierarchy(Graph::fromFile(filename)) {}
+
+ContractionHierarchy::ContractionHierarchy(std::shared_ptr<const Graph> graph, Profile profile)
+    : ShortestPathBase(std::move(graph)) {
+    hierarchy = preprocess(*this->graph, profile);
+}
+
+ContractionHierarchy::ContractionHierarchy(std::shared_ptr<const Graph> graph,
+                                           std::shared_ptr<const Hierarchy> hierarchy)
+    : ShortestPathBase(std::move(graph)), hierarchy(std::move(hierarchy)) {
+    if (!this->hierarchy || this->hierarchy->rank.size() != this->graph->nodeCount()) {
+        throw std::invalid_argument("ContractionHierarchy: hierarchy does not match graph");
+    }
+}
+
+// The a-b edge is stored once, on whichever endpoint has the lower rank
+Graph::EdgeId ContractionHierarchy::findUpEdge(NodeId a, NodeId b) const{
+    const Hierarchy& h = *hierarchy;
+    NodeId low = h.rank[a] < h.rank[b] ? a : b;
+    NodeId high = low == a ? b : a;
+    for (Graph::EdgeId e = h.upOffsets[low]; e < h.upOffsets[low + 1]; ++e) {
+        if (h.upTargets[e] == high) return e;
+    }
+    throw std::logic_error("ContractionHierarchy: missing upward edge while unpacking");
+}
+
+// Appends the original nodes strictly after from, up to and including to
+void ContractionHierarchy::unpack(NodeId from, NodeId to, std::vector<NodeId>& out) const{
+    std::vector<std::pair<NodeId, NodeId>> stack = {{from, to}};
+    while (!stack.empty()) {
+        auto [a, b] = stack.back();
+        stack.pop_back();
+
+        NodeId middle = hierarchy->upMiddle[findUpEdge(a, b)];
+        if (middle == Graph::kInvalidNode) {
+            out.push_back(b);
+        } else {
+            stack.push_back({middle, b}); // processed second
+            stack.push_back({a, middle});
+        }
+    }
+}
+
+void ContractionHierarchy::requireProfile(Profile profile) const{
+    if (profile != hierarchy->profile) {
+        throw std::invalid_argument(std::string("ContractionHierarchy: preprocessed for the ") +
+                                    RoutingProfile::name(hierarchy->profile) + " profile, not " +
+                                    RoutingProfile::name(profile));
+    }
+}
+
+ContractionHierarchy::PathResult ContractionHierarchy::computePath(const Graph::EdgePoint& start,
+                                                                 const Graph::EdgePoint& end, Profile profile) const{
+    requireProfile(profile); // before any early return for invalid or disconnected points
+    return computePathViaEdgeEnds(start, end, profile);
+}
+
+ContractionHierarchy::PathResult ContractionHierarchy::computePath(NodeId source, NodeId target, Profile profile) const{
+    auto startTime = std::chrono::high_resolution_clock::now();
+    requireProfile(profile);
+
+    PathResult result;
+    result.reachable = false;
+    result.weight = 0.0;
+    result.elapsedMs = 0.0;
+
+    if (source >= graph->nodeCount() || target >= graph->nodeCount()) {
+        return result; // edge check
+    }
+    if (!graph->connected(source, target)) {
+        return finish(result, startTime); // different components: nothing to search
+    }
+
+    auto scratch = scratchPool.acquire();
+    SearchWorkspace& workspace = scratch->workspace;
+    SearchWorkspace& backward = scratch->backward;
+    MinQueue& pq = scratch->pq;
+    MinQueue& backwardPq = scratch->backwardPq;
+
+    Init(*scratch);  //Fresh generation for the forward side
+    backward.prepare(graph->nodeCount());
+    while (!backwardPq.empty()) backwardPq.pop();
+
+    const Hierarchy& h = *hierarchy;
+
+    workspace.update(source, 0, Graph::kInvalidNode);
+    backward.update(target, 0, Graph::kInvalidNode);
+    pq.push(PQItem{0, source});
+    backwardPq.push(PQItem{0, target});
+
+    double best = kInfinity;
+    NodeId meet = Graph::kInvalidNode;
+    bool forwardTurn = true;
+
+    // Both upward searches run until their minimum can no longer improve on best
+    while(true){
+        bool forwardLive = !pq.empty() && pq.top().first < best;
+        bool backwardLive = !backwardPq.empty() && backwardPq.top().first < best;
+        if (!forwardLive && !backwardLive) break;
+        if (!forwardLive) forwardTurn = false;
+        if (!backwardLive) forwardTurn = true;
+
+        auto& queue = forwardTurn ? pq : backwardPq;
+        SearchWorkspace& self = forwardTurn ? workspace : backward;
+        const SearchWorkspace& other = forwardTurn ? backward : workspace;
+        forwardTurn = !forwardTurn;
+
+        auto [removed_dist, removed] = queue.top();
+        queue.pop();
+
+        if (self.isSettled(removed)) continue;
+        if (removed_dist > self.distance(removed)) continue;
+        self.settle(removed);
+
+        double through = removed_dist + other.distance(removed);
+        if (through < best) {
+            best = through;
+            meet = removed;
+        }
+
+        for(Graph::EdgeId e = h.upOffsets[removed]; e < h.upOffsets[removed + 1]; ++e){
+            NodeId next = h.upTargets[e];
+            double newDist = removed_dist + h.upWeights[e];
+            if(newDist < self.distance(next)){
+                self.update(next, newDist, removed);
+                queue.push(PQItem{newDist, next});
+            }
+        }
+    }
+
+    result.touchedNodes = workspace.stats().lastTouched + backward.stats().lastTouched;
+    result.settledNodes = workspace.stats().lastSettled + backward.stats().lastSettled;
+
+    if (meet == Graph::kInvalidNode) {
+        return finish(result, startTime); //reachable = false
+    }
+
+    // Up-path source..meet, then down-path meet..target, both in hierarchy edges
+    std::vector<NodeId> hops;
+    for (NodeId v = meet; v != Graph::kInvalidNode; v = workspace.parent(v)) hops.push_back(v);
+    std::reverse(hops.begin(), hops.end());
+    for (NodeId v = backward.parent(meet); v != Graph::kInvalidNode; v = backward.parent(v)) hops.push_back(v);
+
+    std::vector<NodeId> nodes = {hops.front()};
+    for (std::size_t i = 0; i + 1 < hops.size(); ++i) unpack(hops[i], hops[i + 1], nodes);
+
+    result.path.reserve(nodes.size());
+    for (NodeId v : nodes) result.path.push_back(graph->nodeName(v));
+
+    result.reachable = true;
+    result.weight = best;
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    result.elapsedMs =
+        std::chrono::duration<double, std::milli>(endTime - startTime).count();
+    return result;
+}
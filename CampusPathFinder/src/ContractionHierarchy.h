@@ -0,0 +1,61 @@
+#ifndef CONTRACTIONHIERARCHY_H
+#define CONTRACTIONHIERARCHY_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "Graph.h"
+#include "ShortestPathBase.h"
+
+// Contraction Hierarchies: an offline pass contracts nodes one at a time
+// (cheapest edge difference first, witness searches to avoid unneeded
+// shortcuts); queries then run a bidirectional search that only climbs to
+// higher-ranked nodes and unpacks shortcuts into the ordinary node path.
+// A hierarchy is contracted over one routing profile's costs and only
+// answers queries for that profile.
+class ContractionHierarchy : public ShortestPathBase {
+    public:
+        // Preprocessed hierarchy. Since walkways are undirected, one upward
+        // graph (edges from each node to higher-ranked neighbors) serves both
+        // search directions. middle is the contracted node a shortcut bypasses,
+        // or kInvalidNode for an original edge.
+        struct Hierarchy {
+            std::vector<std::uint32_t> rank;
+            std::vector<Graph::EdgeId> upOffsets;
+            std::vector<Graph::NodeId> upTargets;
+            std::vector<double> upWeights;
+            std::vector<Graph::NodeId> upMiddle;
+            std::size_t shortcuts = 0;
+            double buildMs = 0.0;
+            Graph::Profile profile = Graph::Profile::Walking; // whose edge costs were contracted
+
+            void save(const std::string& filename, const Graph& graph) const;
+            static std::shared_ptr<const Hierarchy> load(const std::string& filename, const Graph& graph);
+        };
+
+        // Edges the profile closes are left out of the hierarchy
+        static std::shared_ptr<const Hierarchy> preprocess(const Graph& graph,
+                                                           Graph::Profile profile = Graph::Profile::Walking);
+
+        explicit ContractionHierarchy(const std::string& filename);
+        explicit ContractionHierarchy(std::shared_ptr<const Graph> graph,
+                                      Profile profile = Profile::Walking); // preprocesses
+        ContractionHierarchy(std::shared_ptr<const Graph> graph, std::shared_ptr<const Hierarchy> hierarchy);
+        using ShortestPathBase::computePath;
+        // Throws std::invalid_argument for a profile the hierarchy was not built for
+        PathResult computePath(NodeId source, NodeId target, Profile profile) const override;
+        // Edge points (and so coordinates) too: one hierarchy query per pair of edge ends
+        PathResult computePath(const Graph::EdgePoint& start, const Graph::EdgePoint& end,
+                               Profile profile = Profile::Walking) const override;
+
+        const std::shared_ptr<const Hierarchy>& sharedHierarchy() const { return hierarchy; }
+
+    private:
+        void requireProfile(Profile profile) const;
+        Graph::EdgeId findUpEdge(NodeId a, NodeId b) const;
+        void unpack(NodeId from, NodeId to, std::vector<NodeId>& out) const;
+
+        std::shared_ptr<const Hierarchy> hierarchy;
+};
+
+#endif
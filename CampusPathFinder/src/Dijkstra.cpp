@@ -2,12 +2,16 @@
 #include "Dijkstra.h"
 
 
-Dijkstra::Dijkstra(const std::string& filename){
-    graph.loadFromFile(filename);
-    Init();
-}
+template <typename Queue>
+BasicDijkstra<Queue>::BasicDijkstra(const std::string& filename)
+    : ShortestPathBase(Graph::fromFile(filename)) {}
+
+template <typename Queue>
+BasicDijkstra<Queue>::BasicDijkstra(std::shared_ptr<const Graph> graph)
+    : ShortestPathBase(std::move(graph)) {}
 
-Dijkstra::PathResult Dijkstra::computePath(const std::string& start, const std::string& end){ //Using Dijkstra's algorithm to find best path
+template <typename Queue>
+typename BasicDijkstra<Queue>::PathResult BasicDijkstra<Queue>::computePath(NodeId source, NodeId target, Profile profile) const{ //Using Dijkstra's algorithm to find best path
     auto startTime = std::chrono::high_resolution_clock::now();
 
     PathResult result;
@@ -15,59 +19,60 @@ Dijkstra::PathResult Dijkstra::computePath(const std::string& start, const std::
     result.weight = 0.0;
     result.elapsedMs = 0.0;
     
-    if (!graph.containsNode(start) || !graph.containsNode(end)) {
+    if (source >= graph->nodeCount() || target >= graph->nodeCount()) {
         return result; // edge check
     }
+    if (!graph->connected(source, target)) {
+        return finish(result, startTime); // different components: nothing to search
+    }
 
-    Init();  //Resets member variables in the case the program has ran before
+    auto scratch = queuePool.acquire();
+    SearchWorkspace& workspace = scratch->workspace;
+    Queue& queue = scratch->queue;
+    workspace.prepare(graph->nodeCount());  //Fresh generation; this call's scratch is private to it
+    queue.reset(graph->nodeCount());
     
-    dist[start] = 0;
-    pq.push(PQItem{0,start});
+    workspace.update(source, 0, Graph::kInvalidNode);
+    queue.push(PQItem{0,source});
     
     
-    while(!pq.empty()){
-        PQItem cur = pq.top();
-        pq.pop();
+    while(!queue.empty()){
+        PQItem cur = queue.top();
+        queue.pop();
 
         double removed_dist = cur.first;
-        std::string removed = cur.second;
+        NodeId removed = cur.second;
 
-        if (visited[removed]) continue;
-        if (removed_dist > dist[removed]) continue;
+        if (workspace.isSettled(removed) || removed_dist > workspace.distance(removed)) {
+            queue.countStale(); // only lazy queues leave these behind
+            continue;
+        }
 
-        visited[removed] = true;
+        workspace.settle(removed);
 
-        if (removed == end) break;
+        if (removed == target) break;
         
-        for(auto& edge : graph.getNeighbors(removed)){
-            if(visited[edge.first]) continue;
-            double newDist = removed_dist + edge.second;
-            if(newDist < dist[edge.first]){
-                dist[edge.first] = newDist;
-                prev[edge.first] = removed;
-                pq.push(PQItem{newDist, edge.first});
+        for(Graph::Neighbor edge : graph->neighbors(removed, profile)){
+            NodeId next = edge.to;
+            if(workspace.isSettled(next)) continue;
+            double newDist = removed_dist + edge.weight;
+            if(newDist < workspace.distance(next)){
+                workspace.update(next, newDist, removed);
+                queue.push(PQItem{newDist, next});
             }
         }
     }
     
-    if (dist[end] == std::numeric_limits<double>::infinity()) {
-        return result; //reachable = false
-    }
-    
-    std::vector<std::string> forwardPath;
-
-    std::string traversal = end;
+    result.touchedNodes = workspace.stats().lastTouched;
+    result.settledNodes = workspace.stats().lastSettled;
 
-    while(traversal != start){
-        forwardPath.push_back(traversal);
-        traversal = prev.at(traversal);
+    if (workspace.distance(target) == std::numeric_limits<double>::infinity()) {
+        return finish(result, startTime); //reachable = false
     }
-    forwardPath.push_back(start);
     
-    std::reverse(forwardPath.begin(),forwardPath.end());
     result.reachable = true;
-    result.path = forwardPath;
-    result.weight = dist[end];
+    result.path = buildPath(source, target, workspace);
+    result.weight = workspace.distance(target);
     
     auto endTime = std::chrono::high_resolution_clock::now();
     result.elapsedMs =
@@ -75,5 +80,21 @@ Dijkstra::PathResult Dijkstra::computePath(const std::string& start, const std::
     return result;
 }
 
+template <typename Queue>
+SearchWorkspace::Stats BasicDijkstra<Queue>::workspaceStats() const{
+    SearchWorkspace::Stats total;
+    queuePool.forEachIdle([&](const QueueScratch& scratch) { addStats(total, scratch.workspace); });
+    return total;
+}
 
+template <typename Queue>
+QueueStats BasicDijkstra<Queue>::queueStats() const{
+    QueueStats total;
+    queuePool.forEachIdle([&](const QueueScratch& scratch) { total += scratch.queue.stats(); });
+    return total;
+}
 
+template class BasicDijkstra<BinaryHeapQueue>;
+template class BasicDijkstra<QuaternaryHeapQueue>;
+template class BasicDijkstra<RadixHeapQueue>;
+template class BasicDijkstra<PairingHeapQueue>;
@@ -2,12 +2,34 @@
 #define DIJKSTRA_H
 
 #include "Graph.h"
+#include "PriorityQueues.h"
 #include "ShortestPathBase.h"
 
-class Dijkstra : public ShortestPathBase {
+// Queue is one of the policies in PriorityQueues.h; the instantiations live in Dijkstra.cpp.
+template <typename Queue>
+class BasicDijkstra : public ShortestPathBase {
     public:
-        explicit Dijkstra(const std::string& filename);
-         PathResult computePath(const std::string& start, const std::string& end) override;
+        explicit BasicDijkstra(const std::string& filename);
+        explicit BasicDijkstra(std::shared_ptr<const Graph> graph);
+        using ShortestPathBase::computePath;
+        PathResult computePath(NodeId source, NodeId target, Profile profile) const override;
+
+        SearchWorkspace::Stats workspaceStats() const override;
+        QueueStats queueStats() const; // totals over idle scratch, like workspaceStats()
+
+    private:
+        struct QueueScratch {
+            SearchWorkspace workspace;
+            Queue queue;
+        };
+        ScratchPool<QueueScratch> queuePool;
 };
 
+extern template class BasicDijkstra<BinaryHeapQueue>;
+extern template class BasicDijkstra<QuaternaryHeapQueue>;
+extern template class BasicDijkstra<RadixHeapQueue>;
+extern template class BasicDijkstra<PairingHeapQueue>;
+
+using Dijkstra = BasicDijkstra<BinaryHeapQueue>;
+
 #endif
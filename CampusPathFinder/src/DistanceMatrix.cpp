@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <stdexcept>
+#include "DistanceMatrix.h"
+#include "ThreadPool.h"
+
+namespace {
+constexpr double kInfinity = std::numeric_limits<double>::infinity();
+}
+
+DistanceMatrix::DistanceMatrix(std::shared_ptr<const Graph> graph)
+    : graph(std::move(graph)) {
+    if (!this->graph) {
+        throw std::invalid_argument("DistanceMatrix: graph must not be null");
+    }
+}
+
+DistanceMatrix::Table DistanceMatrix::compute(std::span<const NodeId> sources, std::span<const NodeId> targets,
+                                              ThreadPool* pool) const{
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    Table table;
+    table.rows = sources.size();
+    table.cols = targets.size();
+    table.values.assign(table.rows * table.cols, kInfinity);
+
+    // Each distinct target node gets one slot; columns map back to their slot
+    std::vector<std::uint32_t> targetSlot(graph->nodeCount(), kNoSlot);
+    std::vector<NodeId> distinctTargets;
+    std::vector<std::uint32_t> columnSlot(targets.size(), kNoSlot);
+    for (std::size_t col = 0; col < targets.size(); ++col) {
+        NodeId t = targets[col];
+        if (t >= graph->nodeCount()) continue;
+        if (targetSlot[t] == kNoSlot) {
+            targetSlot[t] = static_cast<std::uint32_t>(distinctTargets.size());
+            distinctTargets.push_back(t);
+        }
+        columnSlot[col] = targetSlot[t];
+    }
+
+    // A search can only ever settle the targets in its own component
+    std::vector<std::size_t> targetsIn(graph->componentCount(), 0);
+    for (NodeId t : distinctTargets) targetsIn[graph->componentOf(t)]++;
+
+    std::vector<std::size_t> settled(sources.size(), 0);
+    auto fillRows = [&](std::size_t begin, std::size_t end) {
+        std::vector<double> slotDistances(distinctTargets.size());
+        for (std::size_t row = begin; row < end; ++row) {
+            if (sources[row] >= graph->nodeCount()) continue;
+            const std::size_t reachable = targetsIn[graph->componentOf(sources[row])];
+            if (reachable == 0) continue;
+            settled[row] = searchRow(sources[row], targetSlot, distinctTargets, reachable, slotDistances.data());
+            double* out = table.values.data() + row * table.cols;
+            for (std::size_t col = 0; col < table.cols; ++col) {
+                if (columnSlot[col] != kNoSlot) out[col] = slotDistances[columnSlot[col]];
+            }
+        }
+    };
+    if (pool) {
+        pool->parallelFor(sources.size(), fillRows, 1);
+    } else {
+        fillRows(0, sources.size());
+    }
+
+    for (std::size_t n : settled) table.settledNodes += n;
+    table.elapsedMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - startTime).count();
+    return table;
+}
+
+std::size_t DistanceMatrix::searchRow(NodeId source, const std::vector<std::uint32_t>& targetSlot,
+                                      const std::vector<NodeId>& distinctTargets, std::size_t reachable,
+                                      double* slotDistances) const{
+    auto scratch = scratchPool.acquire();
+    SearchWorkspace& workspace = scratch->workspace;
+    auto& pq = scratch->pq;
+    workspace.prepare(graph->nodeCount());
+    while (!pq.empty()) pq.pop();
+
+    std::fill(slotDistances, slotDistances + distinctTargets.size(), kInfinity);
+    std::size_t remaining = reachable;
+
+    workspace.update(source, 0, Graph::kInvalidNode);
+    pq.push(PQItem{0, source});
+
+    while(!pq.empty() && remaining > 0){
+        auto [removed_dist, removed] = pq.top();
+        pq.pop();
+
+        if (workspace.isSettled(removed) || removed_dist > workspace.distance(removed)) continue;
+        workspace.settle(removed);
+
+        if (targetSlot[removed] != kNoSlot) {
+            slotDistances[targetSlot[removed]] = removed_dist;
+            remaining--;
+        }
+
+        for(Graph::Neighbor edge : graph->neighbors(removed, Graph::Profile::Walking)){
+            NodeId next = edge.to;
+            if(workspace.isSettled(next)) continue;
+            double newDist = removed_dist + edge.weight;
+            if(newDist < workspace.distance(next)){
+                workspace.update(next, newDist, removed);
+                pq.push(PQItem{newDist, next});
+            }
+        }
+    }
+    return workspace.stats().lastSettled;
+}
@@ -0,0 +1,61 @@
+#ifndef DISTANCEMATRIX_H
+#define DISTANCEMATRIX_H
+
+#include <functional>
+#include <memory>
+#include <queue>
+#include <span>
+#include <vector>
+#include "Graph.h"
+#include "ScratchPool.h"
+#include "SearchWorkspace.h"
+
+class ThreadPool;
+
+// Distance tables between node sets. Each source gets one Dijkstra that
+// stops as soon as every target is settled; no paths are materialized.
+// Like the engines, compute() is const and may be called from many threads.
+class DistanceMatrix {
+    public:
+        using NodeId = Graph::NodeId;
+
+        struct Table {
+            std::size_t rows = 0;       // one per source
+            std::size_t cols = 0;       // one per target
+            std::vector<double> values; // row-major meters; infinity if unreachable
+            double elapsedMs = 0.0;
+            std::size_t settledNodes = 0; // summed over all source searches
+
+            double at(std::size_t row, std::size_t col) const { return values[row * cols + col]; }
+        };
+
+        explicit DistanceMatrix(std::shared_ptr<const Graph> graph);
+
+        // Sources and targets may repeat or overlap; invalid IDs give rows /
+        // columns of infinity. With a pool, sources are spread across its
+        // workers; without one everything runs on the calling thread.
+        Table compute(std::span<const NodeId> sources, std::span<const NodeId> targets,
+                      ThreadPool* pool = nullptr) const;
+
+        const std::shared_ptr<const Graph>& sharedGraph() const { return graph; }
+
+    private:
+        using PQItem = std::pair<double, NodeId>;
+        struct Scratch {
+            SearchWorkspace workspace;
+            std::priority_queue<PQItem, std::vector<PQItem>, std::greater<PQItem>> pq;
+        };
+
+        // Fills one row; targetSlot[v] is v's index among the distinct targets or kNoSlot.
+        // Stops once the `reachable` targets sharing the source's component are settled.
+        std::size_t searchRow(NodeId source, const std::vector<std::uint32_t>& targetSlot,
+                              const std::vector<NodeId>& distinctTargets, std::size_t reachable,
+                              double* slotDistances) const;
+
+        static constexpr std::uint32_t kNoSlot = 0xFFFFFFFFu;
+
+        std::shared_ptr<const Graph> graph;
+        ScratchPool<Scratch> scratchPool;
+};
+
+#endif
@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <initializer_list>
+#include <string>
+#include "EdgeAttributes.h"
+
+namespace {
+
+bool isAny(std::string_view value, std::initializer_list<std::string_view> options) {
+    return std::find(options.begin(), options.end(), value) != options.end();
+}
+
+EdgeAttributes::Highway parseHighway(std::string_view v) {
+    using H = EdgeAttributes::Highway;
+    if (v == "footway" || v == "corridor") return H::Footway;
+    if (v == "path" || v == "track" || v == "bridleway") return H::Path;
+    if (v == "pedestrian") return H::Pedestrian;
+    if (v == "steps") return H::Steps;
+    if (v == "cycleway") return H::Cycleway;
+    if (isAny(v, {"service", "living_street", "residential", "unclassified", "tertiary", "secondary", "primary"})) {
+        return H::Road;
+    }
+    return H::Other;
+}
+
+EdgeAttributes::Surface parseSurface(std::string_view v) {
+    using S = EdgeAttributes::Surface;
+    if (isAny(v, {"paved", "asphalt", "concrete", "concrete:plates", "concrete:lanes", "metal", "rubber"})) return S::Paved;
+    if (isAny(v, {"paving_stones", "sett", "cobblestone", "unhewn_cobblestone", "bricks"})) return S::PavingStones;
+    if (isAny(v, {"compacted", "fine_gravel"})) return S::Compacted;
+    if (isAny(v, {"gravel", "pebblestone"})) return S::Gravel;
+    if (isAny(v, {"unpaved", "dirt", "ground", "earth", "grass", "sand", "mud", "woodchips"})) return S::Unpaved;
+    if (v == "wood") return S::Wood;
+    return S::Other;
+}
+
+// A numeric incline as a percent grade: "8%", "-5%" and bare numbers are percent,
+// "5°" is in degrees
+bool readGrade(std::string_view v, double& percent) {
+    const std::string text(v); // strtod: floating-point from_chars is missing from older libc++
+    char* end = nullptr;
+    const double number = std::strtod(text.c_str(), &end);
+    if (end == text.c_str()) return false;
+    const bool degrees = std::string_view(end).starts_with("\u00b0");
+    percent = degrees ? std::tan(number * M_PI / 180.0) * 100.0 : number;
+    return true;
+}
+
+// "up" / "down", or a grade such as "8%" or "-5%"
+EdgeAttributes::Incline parseIncline(std::string_view v) {
+    using I = EdgeAttributes::Incline;
+    if (v == "up") return I::Up;
+    if (v == "down") return I::Down;
+    if (v == "no" || v == "0" || v == "0%") return I::None;
+    double percent = 0.0;
+    if (readGrade(v, percent)) return percent > 0 ? I::Up : percent < 0 ? I::Down : I::None;
+    return I::Unspecified;
+}
+
+// How steep, whichever way: only a numeric incline has a grade
+EdgeAttributes::Grade parseGrade(std::string_view v) {
+    using G = EdgeAttributes::Grade;
+    double percent = 0.0;
+    if (!readGrade(v, percent)) return G::Unknown;
+    percent = std::abs(percent);
+    return percent < 3.0 ? G::Gentle : percent < 6.0 ? G::Moderate : percent <= 8.0 ? G::Steep : G::VerySteep;
+}
+
+} // namespace
+
+void EdgeAttributes::setLayer(int v) {
+    set(kLayer, static_cast<std::uint32_t>(std::clamp(v, -4, 3)) & 7u);
+}
+
+void EdgeAttributes::applyTag(std::string_view key, std::string_view value) {
+    if (key == "highway") {
+        setHighway(parseHighway(value));
+    } else if (key == "surface") {
+        setSurface(parseSurface(value));
+    } else if (key == "crossing" || key == "footway" || key == "crossing:markings" || key == "crossing:signals") {
+        // Several tags describe one crossing; keep the most controlled reading
+        Crossing seen = Crossing::None;
+        if (key == "crossing") {
+            seen = value == "traffic_signals"                                  ? Crossing::Signals
+                 : isAny(value, {"marked", "zebra", "uncontrolled"})           ? Crossing::Marked
+                 : value == "no"                                               ? Crossing::None
+                                                                               : Crossing::Unmarked;
+        } else if (key == "footway") {
+            seen = value == "crossing" ? Crossing::Unmarked : Crossing::None;
+        } else if (key == "crossing:markings") {
+            seen = value == "no" ? Crossing::Unmarked : Crossing::Marked;
+        } else {
+            seen = value == "yes" ? Crossing::Signals : Crossing::Unmarked;
+        }
+        setCrossing(std::max(crossing(), seen));
+    } else if (key == "incline") {
+        setIncline(parseIncline(value));
+        setGrade(parseGrade(value));
+    } else if (key == "lit") {
+        setLit(value == "no" ? Answer::No : Answer::Yes);
+    } else if (key == "covered") {
+        setCovered(value != "no");
+    } else if (key == "bridge") {
+        setBridge(value != "no");
+    } else if (key == "tunnel") {
+        setTunnel(value != "no");
+    } else if (key == "layer") {
+        int layer = 0;
+        auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), layer);
+        if (error == std::errc() && end != value.data()) setLayer(layer);
+    } else if (key == "wheelchair") {
+        setWheelchair(isAny(value, {"yes", "designated"}) ? Answer::Yes
+                      : value == "limited"                 ? Answer::Limited
+                      : value == "no"                      ? Answer::No
+                                                           : Answer::Unknown);
+    } else if (key == "access") {
+        setAccess(isAny(value, {"yes", "permissive", "designated", "public"}) ? Access::Yes
+                  : value == "private"                                         ? Access::Private
+                  : value == "no"                                              ? Access::No
+                                                                               : Access::Restricted);
+    } else if (key == "segregated") {
+        setSegregated(value == "yes" ? Answer::Yes : value == "no" ? Answer::No : Answer::Unknown);
+    } else if (key == "bicycle") {
+        setBicycle(isAny(value, {"yes", "designated", "permissive"}) ? Bicycle::Yes
+                   : value == "dismount"                            ? Bicycle::Dismount
+                   : isAny(value, {"no", "use_sidepath"})           ? Bicycle::No
+                                                                    : Bicycle::Unknown);
+    }
+}
+
+int EdgeAttributes::taggedFields() const {
+    int count = 0;
+    for (Field f : {kHighway, kSurface, kCrossing, kIncline, kLit, kWheelchair, kAccess, kBicycle,
+                    kCovered, kBridge, kTunnel, kLayer, kSegregated, kGrade}) {
+        if (get(f) != 0) count++;
+    }
+    return count;
+}
+
+EdgeAttributes EdgeAttributes::reversed() const {
+    EdgeAttributes other = *this;
+    if (incline() == Incline::Up) other.setIncline(Incline::Down);
+    if (incline() == Incline::Down) other.setIncline(Incline::Up);
+    return other;
+}
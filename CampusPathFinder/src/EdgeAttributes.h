@@ -0,0 +1,106 @@
+#ifndef EDGEATTRIBUTES_H
+#define EDGEATTRIBUTES_H
+
+#include <cstdint>
+#include <string_view>
+
+// OSM tags of the way an edge was drawn from, packed into one 32-bit word
+// kept parallel to the edge weights, so a cost function reads them with a
+// single load inside the relaxation loop. An all-zero word is an untagged
+// way: unknown surface, no crossing, layer 0, access allowed. Directional
+// tags are stored as seen walking the edge, so an edge and its reverse
+// differ in incline.
+class EdgeAttributes {
+    public:
+        enum class Highway : std::uint8_t { Unknown, Footway, Path, Pedestrian, Steps, Cycleway, Road, Other };
+        enum class Surface : std::uint8_t { Unknown, Paved, PavingStones, Compacted, Gravel, Unpaved, Wood, Other };
+        enum class Crossing : std::uint8_t { None, Unmarked, Marked, Signals }; // ordered by how controlled
+        enum class Incline : std::uint8_t { None, Up, Down, Unspecified };
+        enum class Grade : std::uint8_t { Unknown, Gentle, Moderate, Steep, VerySteep }; // <3%, 3-6%, 6-8%, >8%
+        enum class Answer : std::uint8_t { Unknown, Yes, No, Limited };         // lit, wheelchair, segregated
+        enum class Access : std::uint8_t { Yes, Private, No, Restricted };
+        enum class Bicycle : std::uint8_t { Unknown, Yes, Dismount, No };
+
+        EdgeAttributes() = default;
+        static EdgeAttributes fromBits(std::uint32_t bits) { EdgeAttributes a; a.word = bits; return a; }
+        std::uint32_t bits() const { return word; }
+
+        Highway highway() const { return static_cast<Highway>(get(kHighway)); }
+        Surface surface() const { return static_cast<Surface>(get(kSurface)); }
+        Crossing crossing() const { return static_cast<Crossing>(get(kCrossing)); }
+        Incline incline() const { return static_cast<Incline>(get(kIncline)); }
+        Grade grade() const { return static_cast<Grade>(get(kGrade)); } // steepness either way; Unknown unless numeric
+        Answer lit() const { return static_cast<Answer>(get(kLit)); }
+        Answer wheelchair() const { return static_cast<Answer>(get(kWheelchair)); }
+        Access access() const { return static_cast<Access>(get(kAccess)); }
+        Bicycle bicycle() const { return static_cast<Bicycle>(get(kBicycle)); }
+        Answer segregated() const { return static_cast<Answer>(get(kSegregated)); } // bikes kept apart from walkers
+        bool covered() const { return get(kCovered) != 0; }
+        bool bridge() const { return get(kBridge) != 0; }
+        bool tunnel() const { return get(kTunnel) != 0; }
+        int layer() const { // 3-bit two's complement, -4..3
+            const int raw = static_cast<int>(get(kLayer));
+            return raw >= 4 ? raw - 8 : raw;
+        }
+
+        void setHighway(Highway v) { set(kHighway, static_cast<std::uint32_t>(v)); }
+        void setSurface(Surface v) { set(kSurface, static_cast<std::uint32_t>(v)); }
+        void setCrossing(Crossing v) { set(kCrossing, static_cast<std::uint32_t>(v)); }
+        void setIncline(Incline v) { set(kIncline, static_cast<std::uint32_t>(v)); }
+        void setGrade(Grade v) { set(kGrade, static_cast<std::uint32_t>(v)); }
+        void setLit(Answer v) { set(kLit, static_cast<std::uint32_t>(v)); }
+        void setWheelchair(Answer v) { set(kWheelchair, static_cast<std::uint32_t>(v)); }
+        void setAccess(Access v) { set(kAccess, static_cast<std::uint32_t>(v)); }
+        void setBicycle(Bicycle v) { set(kBicycle, static_cast<std::uint32_t>(v)); }
+        void setSegregated(Answer v) { set(kSegregated, static_cast<std::uint32_t>(v)); }
+        void setCovered(bool v) { set(kCovered, v ? 1u : 0u); }
+        void setBridge(bool v) { set(kBridge, v ? 1u : 0u); }
+        void setTunnel(bool v) { set(kTunnel, v ? 1u : 0u); }
+        void setLayer(int v); // clamped to -4..3
+
+        // Folds one OSM tag into the word; unknown keys and values are ignored.
+        // Tags may arrive in any order (e.g. crossing=* and crossing:signals=*).
+        void applyTag(std::string_view key, std::string_view value);
+
+        // The same way walked the other direction
+        EdgeAttributes reversed() const;
+
+        // How many fields differ from an untagged way; picks between duplicate segments
+        int taggedFields() const;
+
+        bool operator==(const EdgeAttributes& other) const { return word == other.word; }
+        bool operator!=(const EdgeAttributes& other) const { return word != other.word; }
+
+    private:
+        struct Field {
+            unsigned shift;
+            unsigned width;
+        };
+        static constexpr Field kHighway{0, 3};
+        static constexpr Field kSurface{3, 3};
+        static constexpr Field kCrossing{6, 2};
+        static constexpr Field kIncline{8, 2};
+        static constexpr Field kLit{10, 2};
+        static constexpr Field kWheelchair{12, 2};
+        static constexpr Field kAccess{14, 2};
+        static constexpr Field kBicycle{16, 2};
+        static constexpr Field kCovered{18, 1};
+        static constexpr Field kBridge{19, 1};
+        static constexpr Field kTunnel{20, 1};
+        static constexpr Field kLayer{21, 3};
+        static constexpr Field kSegregated{24, 2};
+        static constexpr Field kGrade{26, 3};
+        // bits 29..31 are free
+
+        std::uint32_t get(Field f) const { return (word >> f.shift) & ((1u << f.width) - 1); }
+        void set(Field f, std::uint32_t v) {
+            const std::uint32_t mask = ((1u << f.width) - 1) << f.shift;
+            word = (word & ~mask) | ((v << f.shift) & mask);
+        }
+
+        std::uint32_t word = 0;
+};
+
+static_assert(sizeof(EdgeAttributes) == 4, "EdgeAttributes is stored in snapshots as one word");
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef FROZENARRAY_H
+#define FROZENARRAY_H
+
+#include <cstddef>
+#include <span>
+#include <utility>
+#include <vector>
+
+// Read-only array that either owns its elements (graph built in-process) or
+// views memory owned elsewhere (a mapped snapshot). Callers see the same
+// interface either way; whoever maps the memory must keep it alive.
+template <typename T>
+class FrozenArray {
+    public:
+        FrozenArray() = default;
+
+        FrozenArray(const FrozenArray& other) : owned(other.owned) {
+            rebind(other);
+        }
+        FrozenArray(FrozenArray&& other) noexcept : owned(std::move(other.owned)) {
+            rebind(other);
+            other.reset();
+        }
+        FrozenArray& operator=(const FrozenArray& other) {
+            if (this != &other) {
+                owned = other.owned;
+                rebind(other);
+            }
+            return *this;
+        }
+        FrozenArray& operator=(FrozenArray&& other) noexcept {
+            if (this != &other) {
+                owned = std::move(other.owned);
+                rebind(other);
+                other.reset();
+            }
+            return *this;
+        }
+
+        void assign(std::vector<T>&& values) {
+            owned = std::move(values);
+            ptr = owned.data();
+            count = owned.size();
+        }
+        void view(const T* data, std::size_t size) {
+            owned = {};
+            ptr = data;
+            count = size;
+        }
+        void reset() {
+            owned = {};
+            ptr = nullptr;
+            count = 0;
+        }
+
+        const T& operator[](std::size_t i) const { return ptr[i]; }
+        const T* data() const { return ptr; }
+        std::size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+        bool isView() const { return ptr != nullptr && owned.empty(); }
+
+        const T* begin() const { return ptr; }
+        const T* end() const { return ptr + count; }
+        std::span<const T> span() const { return {ptr, count}; }
+
+    private:
+        // Point at our own copy if other owned its data, otherwise share other's view
+        void rebind(const FrozenArray& other) {
+            if (other.isView()) {
+                ptr = other.ptr;
+            } else {
+                ptr = owned.data();
+            }
+            count = other.count;
+        }
+
+        std::vector<T> owned;
+        const T* ptr = nullptr;
+        std::size_t count = 0;
+};
+
+#endif
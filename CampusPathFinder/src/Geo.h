@@ -0,0 +1,70 @@
+#ifndef GEO_H
+#define GEO_H
+
+#include <cmath>
+
+// Spherical-earth distance helpers shared by the graph loader and the
+// goal-directed engines. Edge weights are great-circle (haversine) lengths,
+// so anything here that never exceeds the great-circle distance is an
+// admissible A* heuristic.
+namespace Geo {
+
+constexpr double kEarthRadius = 6371000; // meters
+
+inline double deg2rad(double deg) {
+    return deg * M_PI / 180.0;
+}
+
+// Haversine distance between two points (lat/lon in degrees)
+inline double haversine(double lat1, double lon1, double lat2, double lon2) {
+    double dLat = deg2rad(lat2 - lat1);
+    double dLon = deg2rad(lon2 - lon1);
+
+    double a = std::sin(dLat/2) * std::sin(dLat/2) +
+               std::cos(deg2rad(lat1)) * std::cos(deg2rad(lat2)) *
+               std::sin(dLon/2) * std::sin(dLon/2);
+
+    double c = 2 * std::atan2(std::sqrt(a), std::sqrt(1-a));
+    return kEarthRadius * c;
+}
+
+// Per-node trigonometry, computed once at load so heuristics never call
+// sin/cos on degrees: radians, cos(lat), and the unit-sphere position.
+struct Point {
+    double lat;    // radians
+    double lon;    // radians
+    double cosLat;
+    double x;
+    double y;
+    double z;
+};
+
+inline Point toPoint(double latDeg, double lonDeg) {
+    const double lat = deg2rad(latDeg);
+    const double lon = deg2rad(lonDeg);
+    const double cosLat = std::cos(lat);
+    return {lat, lon, cosLat, cosLat * std::cos(lon), cosLat * std::sin(lon), std::sin(lat)};
+}
+
+// Same value as haversine() (up to rounding) with half the trig calls
+inline double greatCircle(const Point& a, const Point& b) {
+    const double sLat = std::sin((b.lat - a.lat) / 2);
+    const double sLon = std::sin((b.lon - a.lon) / 2);
+    const double h = sLat * sLat + a.cosLat * b.cosLat * sLon * sLon;
+    return 2 * kEarthRadius * std::asin(std::sqrt(std::fmin(h, 1.0)));
+}
+
+// Straight-line distance through the earth. A chord is never longer than its
+// arc, and chords obey the triangle inequality, so this is admissible and
+// consistent wherever edge weights are great-circle lengths. At campus scale
+// it is shorter than the arc by about a micrometer over a kilometer.
+inline double chord(const Point& a, const Point& b) {
+    const double dx = a.x - b.x;
+    const double dy = a.y - b.y;
+    const double dz = a.z - b.z;
+    return kEarthRadius * std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+} // namespace Geo
+
+#endif
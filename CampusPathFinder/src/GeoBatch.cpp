@@ -0,0 +1,222 @@
+#include <algorithm>
+#include <cmath>
+#include "GeoBatch.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define GEOBATCH_X86 1
+#include <immintrin.h>
+#if !defined(__clang__)
+// GCC 12 flags the deliberately undefined vectors inside avx512fintrin.h
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+#endif
+
+namespace {
+
+constexpr double kMetersPerUnit = Geo::kEarthRadius;
+constexpr std::size_t kStride = sizeof(Geo::Point) / sizeof(double); // doubles per cached point
+constexpr double kSeriesLimit = 1e-2; // half-chords below this use the asin series
+
+// asin(x) = x (1 + x^2/6 + 3x^4/40 + 15x^6/336 + 105x^8/3456 + ...); the first
+// omitted term is below 1e-20 relative for x < kSeriesLimit
+inline double asinSeries(double x) {
+    double x2 = x * x;
+    return x * (1.0 + x2 * (1.0 / 6 + x2 * (3.0 / 40 + x2 * (15.0 / 336 + x2 * (105.0 / 3456)))));
+}
+
+inline double arcFromHalfChord(double half) {
+    double angle = half < kSeriesLimit ? asinSeries(half) : std::asin(std::fmin(half, 1.0));
+    return 2 * kMetersPerUnit * angle;
+}
+
+inline double chordSquared(const Geo::Point& a, const Geo::Point& b) {
+    const double dx = a.x - b.x;
+    const double dy = a.y - b.y;
+    const double dz = a.z - b.z;
+    return dx * dx + dy * dy + dz * dz;
+}
+
+void chordScalar(const Geo::Point* points, const std::uint32_t* ids, std::size_t count,
+                 const Geo::Point& target, double* out) {
+    for (std::size_t i = 0; i < count; ++i) {
+        out[i] = kMetersPerUnit * std::sqrt(chordSquared(points[ids[i]], target));
+    }
+}
+
+void arcScalar(const Geo::Point* points, const std::uint32_t* from, const std::uint32_t* to,
+               std::size_t count, double* out) {
+    for (std::size_t i = 0; i < count; ++i) {
+        out[i] = arcFromHalfChord(0.5 * std::sqrt(chordSquared(points[from[i]], points[to[i]])));
+    }
+}
+
+#ifdef GEOBATCH_X86
+
+// Lanes gather x / y / z straight out of the array of Geo::Points: node ID * kStride
+// doubles from &points->x (+1 for y, +2 for z), using 64-bit offsets so any ID fits.
+
+__attribute__((target("avx2,fma")))
+inline __m256i offsets4(const std::uint32_t* ids) {
+    __m256i wide = _mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ids)));
+    return _mm256_mul_epu32(wide, _mm256_set1_epi64x(kStride));
+}
+
+__attribute__((target("avx2,fma")))
+inline __m256d chordSquared4(const double* base, __m256i a, const Geo::Point& b) {
+    __m256d dx = _mm256_sub_pd(_mm256_i64gather_pd(base, a, 8), _mm256_set1_pd(b.x));
+    __m256d dy = _mm256_sub_pd(_mm256_i64gather_pd(base + 1, a, 8), _mm256_set1_pd(b.y));
+    __m256d dz = _mm256_sub_pd(_mm256_i64gather_pd(base + 2, a, 8), _mm256_set1_pd(b.z));
+    return _mm256_fmadd_pd(dz, dz, _mm256_fmadd_pd(dy, dy, _mm256_mul_pd(dx, dx)));
+}
+
+__attribute__((target("avx2,fma")))
+void chordAvx2(const Geo::Point* points, const std::uint32_t* ids, std::size_t count,
+               const Geo::Point& target, double* out) {
+    const double* base = &points->x;
+    const __m256d scale = _mm256_set1_pd(kMetersPerUnit);
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256d c2 = chordSquared4(base, offsets4(ids + i), target);
+        _mm256_storeu_pd(out + i, _mm256_mul_pd(scale, _mm256_sqrt_pd(c2)));
+    }
+    chordScalar(points, ids + i, count - i, target, out + i);
+}
+
+__attribute__((target("avx2,fma")))
+void arcAvx2(const Geo::Point* points, const std::uint32_t* from, const std::uint32_t* to,
+             std::size_t count, double* out) {
+    const double* base = &points->x;
+    const __m256d limit = _mm256_set1_pd(kSeriesLimit);
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256i a = offsets4(from + i);
+        __m256i b = offsets4(to + i);
+        __m256d dx = _mm256_sub_pd(_mm256_i64gather_pd(base, a, 8), _mm256_i64gather_pd(base, b, 8));
+        __m256d dy = _mm256_sub_pd(_mm256_i64gather_pd(base + 1, a, 8), _mm256_i64gather_pd(base + 1, b, 8));
+        __m256d dz = _mm256_sub_pd(_mm256_i64gather_pd(base + 2, a, 8), _mm256_i64gather_pd(base + 2, b, 8));
+        __m256d c2 = _mm256_fmadd_pd(dz, dz, _mm256_fmadd_pd(dy, dy, _mm256_mul_pd(dx, dx)));
+        __m256d x = _mm256_mul_pd(_mm256_set1_pd(0.5), _mm256_sqrt_pd(c2));
+        __m256d x2 = _mm256_mul_pd(x, x);
+        __m256d poly = _mm256_fmadd_pd(x2, _mm256_set1_pd(105.0 / 3456), _mm256_set1_pd(15.0 / 336));
+        poly = _mm256_fmadd_pd(x2, poly, _mm256_set1_pd(3.0 / 40));
+        poly = _mm256_fmadd_pd(x2, poly, _mm256_set1_pd(1.0 / 6));
+        poly = _mm256_fmadd_pd(x2, poly, _mm256_set1_pd(1.0));
+        _mm256_storeu_pd(out + i, _mm256_mul_pd(_mm256_set1_pd(2 * kMetersPerUnit), _mm256_mul_pd(x, poly)));
+        if (_mm256_movemask_pd(_mm256_cmp_pd(x, limit, _CMP_GE_OQ))) {
+            arcScalar(points, from + i, to + i, 4, out + i); // a segment over ~100 km: rare, redo exactly
+        }
+    }
+    arcScalar(points, from + i, to + i, count - i, out + i);
+}
+
+__attribute__((target("avx512f")))
+inline __m512i offsets8(const std::uint32_t* ids) {
+    __m512i wide = _mm512_cvtepu32_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(ids)));
+    return _mm512_mul_epu32(wide, _mm512_set1_epi64(kStride));
+}
+
+__attribute__((target("avx512f")))
+void chordAvx512(const Geo::Point* points, const std::uint32_t* ids, std::size_t count,
+                 const Geo::Point& target, double* out) {
+    const double* base = &points->x;
+    const __m512d scale = _mm512_set1_pd(kMetersPerUnit);
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m512i a = offsets8(ids + i);
+        __m512d dx = _mm512_sub_pd(_mm512_i64gather_pd(a, base, 8), _mm512_set1_pd(target.x));
+        __m512d dy = _mm512_sub_pd(_mm512_i64gather_pd(a, base + 1, 8), _mm512_set1_pd(target.y));
+        __m512d dz = _mm512_sub_pd(_mm512_i64gather_pd(a, base + 2, 8), _mm512_set1_pd(target.z));
+        __m512d c2 = _mm512_fmadd_pd(dz, dz, _mm512_fmadd_pd(dy, dy, _mm512_mul_pd(dx, dx)));
+        _mm512_storeu_pd(out + i, _mm512_mul_pd(scale, _mm512_sqrt_pd(c2)));
+    }
+    chordAvx2(points, ids + i, count - i, target, out + i);
+}
+
+__attribute__((target("avx512f")))
+void arcAvx512(const Geo::Point* points, const std::uint32_t* from, const std::uint32_t* to,
+               std::size_t count, double* out) {
+    const double* base = &points->x;
+    const __m512d limit = _mm512_set1_pd(kSeriesLimit);
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m512i a = offsets8(from + i);
+        __m512i b = offsets8(to + i);
+        __m512d dx = _mm512_sub_pd(_mm512_i64gather_pd(a, base, 8), _mm512_i64gather_pd(b, base, 8));
+        __m512d dy = _mm512_sub_pd(_mm512_i64gather_pd(a, base + 1, 8), _mm512_i64gather_pd(b, base + 1, 8));
+        __m512d dz = _mm512_sub_pd(_mm512_i64gather_pd(a, base + 2, 8), _mm512_i64gather_pd(b, base + 2, 8));
+        __m512d c2 = _mm512_fmadd_pd(dz, dz, _mm512_fmadd_pd(dy, dy, _mm512_mul_pd(dx, dx)));
+        __m512d x = _mm512_mul_pd(_mm512_set1_pd(0.5), _mm512_sqrt_pd(c2));
+        __m512d x2 = _mm512_mul_pd(x, x);
+        __m512d poly = _mm512_fmadd_pd(x2, _mm512_set1_pd(105.0 / 3456), _mm512_set1_pd(15.0 / 336));
+        poly = _mm512_fmadd_pd(x2, poly, _mm512_set1_pd(3.0 / 40));
+        poly = _mm512_fmadd_pd(x2, poly, _mm512_set1_pd(1.0 / 6));
+        poly = _mm512_fmadd_pd(x2, poly, _mm512_set1_pd(1.0));
+        _mm512_storeu_pd(out + i, _mm512_mul_pd(_mm512_set1_pd(2 * kMetersPerUnit), _mm512_mul_pd(x, poly)));
+        if (_mm512_cmp_pd_mask(x, limit, _CMP_GE_OQ)) {
+            arcScalar(points, from + i, to + i, 8, out + i);
+        }
+    }
+    arcAvx2(points, from + i, to + i, count - i, out + i);
+}
+
+#endif
+
+} // namespace
+
+namespace GeoBatch {
+
+bool supported(Kernel kernel) {
+#ifdef GEOBATCH_X86
+    static const bool avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    static const bool avx512 = avx2 && __builtin_cpu_supports("avx512f");
+    switch (kernel) {
+        case Kernel::Scalar: return true;
+        case Kernel::Avx2: return avx2;
+        case Kernel::Avx512: return avx512;
+    }
+    return false;
+#else
+    return kernel == Kernel::Scalar;
+#endif
+}
+
+Kernel bestKernel() {
+    static const Kernel best = supported(Kernel::Avx512) ? Kernel::Avx512
+                             : supported(Kernel::Avx2)   ? Kernel::Avx2
+                                                         : Kernel::Scalar;
+    return best;
+}
+
+const char* name(Kernel kernel) {
+    switch (kernel) {
+        case Kernel::Scalar: return "scalar";
+        case Kernel::Avx2: return "AVX2";
+        case Kernel::Avx512: return "AVX-512";
+    }
+    return "unknown";
+}
+
+// Kernels the CPU lacks quietly fall back to scalar
+void chordDistances(const Geo::Point* points, const std::uint32_t* ids, std::size_t count,
+                    const Geo::Point& target, double* out, Kernel kernel) {
+#ifdef GEOBATCH_X86
+    if (kernel == Kernel::Avx512 && supported(kernel)) return chordAvx512(points, ids, count, target, out);
+    if (kernel != Kernel::Scalar && supported(Kernel::Avx2)) return chordAvx2(points, ids, count, target, out);
+#else
+    (void)kernel;
+#endif
+    chordScalar(points, ids, count, target, out);
+}
+
+void arcDistances(const Geo::Point* points, const std::uint32_t* from, const std::uint32_t* to,
+                  std::size_t count, double* out, Kernel kernel) {
+#ifdef GEOBATCH_X86
+    if (kernel == Kernel::Avx512 && supported(kernel)) return arcAvx512(points, from, to, count, out);
+    if (kernel != Kernel::Scalar && supported(Kernel::Avx2)) return arcAvx2(points, from, to, count, out);
+#else
+    (void)kernel;
+#endif
+    arcScalar(points, from, to, count, out);
+}
+
+} // namespace GeoBatch
@@ -0,0 +1,32 @@
+#ifndef GEOBATCH_H
+#define GEOBATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include "Geo.h"
+
+// Distance kernels over many nodes at once, reading the graph's cached
+// Geo::Point array by node ID. On x86-64 the AVX2 / AVX-512 versions are
+// picked at runtime from the CPU's features; everywhere else, and on CPUs
+// without them, the scalar loop runs instead. All kernels compute the same
+// formulas, so results agree across kernels to the last few bits.
+namespace GeoBatch {
+
+enum class Kernel { Scalar, Avx2, Avx512 };
+
+Kernel bestKernel(); // widest kernel this CPU supports, detected once
+bool supported(Kernel kernel);
+const char* name(Kernel kernel);
+
+// out[i] = Geo::chord(points[ids[i]], target)
+void chordDistances(const Geo::Point* points, const std::uint32_t* ids, std::size_t count,
+                    const Geo::Point& target, double* out, Kernel kernel = bestKernel());
+
+// out[i] = great-circle meters between points[from[i]] and points[to[i]], taken
+// from the chord (no trig calls for anything shorter than ~100 km)
+void arcDistances(const Geo::Point* points, const std::uint32_t* from, const std::uint32_t* to,
+                  std::size_t count, double* out, Kernel kernel = bestKernel());
+
+} // namespace GeoBatch
+
+#endif
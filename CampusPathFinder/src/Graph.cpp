@@ -1,139 +1,989 @@
 #include "Graph.h"
+#include "GeoBatch.h"
 #include <iostream>
 #include <vector>
 #include <unordered_map>
 #include <string>
 #include <fstream>
+#include <algorithm>
+#include <cmath>
+#include <chrono>
+#include <functional>
+#include <stdexcept>
+#include <cstdio>
+#include <cstdlib>
 #include "json.hpp"
 using json = nlohmann::json;
 
-void Graph::loadFromFile(const std::string& filename){
-    parseFile(filename);
+std::shared_ptr<const Graph> Graph::fromFile(const std::string& filename, NodeOrder order){
+    return fromFile(filename, LoadOptions{order});
+}
+
+std::shared_ptr<const Graph> Graph::fromFile(const std::string& filename, const LoadOptions& options){
+    auto graph = std::make_shared<Graph>();
+    graph->loadFromFile(filename, options);
+    return graph;
+}
+
+void Graph::loadFromFile(const std::string& filename, NodeOrder order){
+    loadFromFile(filename, LoadOptions{order});
+}
+
+void Graph::loadFromFile(const std::string& filename, const LoadOptions& options){
+    parseFile(filename, options);
+}
+
+std::shared_ptr<const Graph> Graph::fromSnapshot(const std::string& filename, bool verifyChecksums){
+    auto graph = std::make_shared<Graph>();
+    graph->loadSnapshot(filename, verifyChecksums);
+    return graph;
 }
 
 bool Graph::containsNode(const std::string& node) const {
-    return nodeData.find(node) != nodeData.end();
+    return nodeId(node) != kInvalidNode;
+}
+
+Graph::NodeKey Graph::coordinateKey(double lat, double lon) {
+    auto latE7 = static_cast<std::int32_t>(std::llround(lat * kKeyScale));
+    auto lonE7 = static_cast<std::int32_t>(std::llround(lon * kKeyScale));
+    return (static_cast<NodeKey>(static_cast<std::uint32_t>(latE7)) << 32) | static_cast<std::uint32_t>(lonE7);
+}
+
+Graph::Coordinate Graph::keyCoordinate(NodeKey key) {
+    auto latE7 = static_cast<std::int32_t>(static_cast<std::uint32_t>(key >> 32));
+    auto lonE7 = static_cast<std::int32_t>(static_cast<std::uint32_t>(key));
+    return {latE7 / kKeyScale, lonE7 / kKeyScale};
+}
+
+// Formats from the integer parts so the text round-trips exactly through parseKey
+std::string Graph::formatKey(NodeKey key) {
+    auto appendFixed = [](std::string& out, std::int32_t valueE7) {
+        std::int64_t v = valueE7;
+        if (v < 0) {
+            out += '-';
+            v = -v;
+        }
+        char frac[8];
+        std::snprintf(frac, sizeof(frac), "%07lld", static_cast<long long>(v % 10000000));
+        out += std::to_string(v / 10000000);
+        out += '.';
+        out += frac;
+    };
+
+    std::string out;
+    out.reserve(24);
+    appendFixed(out, static_cast<std::int32_t>(static_cast<std::uint32_t>(key >> 32)));
+    out += ',';
+    appendFixed(out, static_cast<std::int32_t>(static_cast<std::uint32_t>(key)));
+    return out;
+}
+
+bool Graph::parseKey(const std::string& node, NodeKey& key) {
+    std::size_t comma = node.find(',');
+    if (comma == std::string::npos) return false;
+
+    auto parsePart = [](const std::string& text, double& value) {
+        if (text.empty()) return false;
+        char* end = nullptr;
+        value = std::strtod(text.c_str(), &end);
+        return end == text.c_str() + text.size() && std::isfinite(value);
+    };
+
+    double lat = 0.0, lon = 0.0;
+    if (!parsePart(node.substr(0, comma), lat) || !parsePart(node.substr(comma + 1), lon)) return false;
+    if (std::abs(lat) > 90.0 || std::abs(lon) > 180.0) return false;
+
+    key = coordinateKey(lat, lon);
+    return true;
+}
+
+Graph::NodeId Graph::nodeId(const std::string& node) const {
+    NodeKey key = 0;
+    if (!parseKey(node, key)) return kInvalidNode;
+    return nodeId(key);
+}
+
+// Binary search over the key-sorted ID list
+Graph::NodeId Graph::nodeId(NodeKey key) const {
+    auto it = std::lower_bound(keyOrder.begin(), keyOrder.end(), key,
+        [this](NodeId id, NodeKey k) { return nodeKeys[id] < k; });
+    if (it != keyOrder.end() && nodeKeys[*it] == key) return *it;
+    return kInvalidNode;
 }
 
 Graph::NodeLocation Graph::getNodeLocation(const std::string& nodeId) const {
-    auto it = nodeData.find(nodeId);
-    if (it != nodeData.end()) return it->second;
+    NodeId id = this->nodeId(nodeId);
+    if (id != kInvalidNode) return {lats[id], lons[id], ""};
     return {0.0, 0.0, ""};
 }
 // Key is the starting Node, and value is an array of Nodes to visit with the weight
 std::vector<std::pair<std::string, double>> Graph::getNeighbors(const std::string& node) const{
-    auto it = adjList.find(node);
-    if (it != adjList.end()) return it->second;
-    return {};
+    NodeId u = nodeId(node);
+    if (u == kInvalidNode) return {};
+
+    std::vector<std::pair<std::string, double>> out;
+    out.reserve(neighbors(u).size());
+    for (Neighbor edge : neighbors(u)) {
+        out.push_back({nodeName(edge.to), edge.weight});
+    }
+    return out;
 }
 
 std::unordered_map<std::string, std::vector<std::pair<std::string, double>>> Graph::getList() const{
-    return adjList;
+    std::unordered_map<std::string, std::vector<std::pair<std::string, double>>> list;
+    list.reserve(nodeCount());
+    for (NodeId u : nodes()) {
+        auto& out = list[nodeName(u)];
+        for (Neighbor edge : neighbors(u)) {
+            out.push_back({nodeName(edge.to), edge.weight});
+        }
+    }
+    return list;
 }
 
-double Graph::deg2rad(double deg) {
-    return deg * M_PI / 180.0;
+std::size_t Graph::edgePointCount(EdgeId edge) const {
+    if (edgeShapes.empty() || edgeShapes[edge] == kNoShape) return 2;
+    const std::uint32_t chain = edgeShapes[edge] & ~kReversedShape;
+    return shapeOffsets[chain + 1] - shapeOffsets[chain] + 2;
 }
 
-// Haversine distance between two points (lat/lon in degrees)
-double Graph::haversine(double lat1, double lon1, double lat2, double lon2) {
-    double dLat = deg2rad(lat2 - lat1);
-    double dLon = deg2rad(lon2 - lon1);
+Graph::Coordinate Graph::edgePoint(NodeId from, EdgeId edge, std::size_t i) const {
+    const std::size_t last = edgePointCount(edge) - 1;
+    if (i == 0) return location(from);
+    if (i == last) return location(targets[edge]);
+    const std::uint32_t shape = edgeShapes[edge];
+    const std::uint32_t first = shapeOffsets[shape & ~kReversedShape];
+    return shapePoints[first + ((shape & kReversedShape) ? last - 1 - i : i - 1)];
+}
 
-    double a = std::sin(dLat/2) * std::sin(dLat/2) +
-               std::cos(deg2rad(lat1)) * std::cos(deg2rad(lat2)) *
-               std::sin(dLon/2) * std::sin(dLon/2);
+// Fractions are of the polyline's length, so they scale the edge weight directly
+std::vector<Graph::Coordinate> Graph::edgeGeometry(NodeId from, EdgeId edge, double begin, double end) const {
+    auto lerp = [](const Coordinate& a, const Coordinate& b, double t) {
+        return Coordinate{a.lat + (b.lat - a.lat) * t, a.lon + (b.lon - a.lon) * t};
+    };
+    const std::size_t count = edgePointCount(edge);
+    if (count == 2) {
+        const Coordinate a = location(from);
+        const Coordinate b = location(targets[edge]);
+        return {lerp(a, b, begin), lerp(a, b, end)};
+    }
+    if (begin > end) {
+        std::vector<Coordinate> points = edgeGeometry(from, edge, end, begin);
+        std::reverse(points.begin(), points.end());
+        return points;
+    }
+
+    std::vector<Coordinate> points(count);
+    std::vector<double> along(count, 0.0); // meters from `from` to each point
+    for (std::size_t i = 0; i < count; ++i) {
+        points[i] = edgePoint(from, edge, i);
+        if (i > 0) along[i] = along[i - 1] + Geo::haversine(points[i - 1].lat, points[i - 1].lon, points[i].lat, points[i].lon);
+    }
+    auto at = [&](double t) {
+        const double d = t * along.back();
+        std::size_t i = 1;
+        while (i + 1 < count && along[i] < d) ++i;
+        const double span = along[i] - along[i - 1];
+        return lerp(points[i - 1], points[i], span > 0.0 ? (d - along[i - 1]) / span : 0.0);
+    };
 
-    double c = 2 * std::atan2(std::sqrt(a), std::sqrt(1-a));
-    return kEarthRadius * c;
+    std::vector<Coordinate> result{at(begin)};
+    for (std::size_t i = 1; i + 1 < count; ++i) {
+        if (along[i] > begin * along.back() && along[i] < end * along.back()) result.push_back(points[i]);
+    }
+    result.push_back(at(end));
+    return result;
 }
 
-void Graph::parseFile(const std::string& filename) {
-    adjList.clear();
-    nodeData.clear();
+std::string_view Graph::edgeName(EdgeId e) const {
+    if (edgeNames.empty()) return {};
+    const std::uint32_t id = edgeNames[e];
+    return {nameChars.data() + nameOffsets[id], nameOffsets[id + 1] - nameOffsets[id]};
+}
 
-    std::ifstream inFile(filename);
-    if (!inFile.is_open()) {
-        throw std::runtime_error("Could not open file: " + filename);
+Graph::EdgeId Graph::findEdge(NodeId from, NodeId to, Profile profile) const {
+    EdgeId best = kInvalidEdge;
+    for (Neighbor edge : neighbors(from, profile)) {
+        if (edge.to == to && (best == kInvalidEdge || edge.weight < edgeWeight(best, profile))) best = edge.edge;
     }
+    return best;
+}
 
-    nlohmann::json j;
-    inFile >> j;
+Graph::EdgeId Graph::reverseEdge(NodeId from, EdgeId edge) const {
+    auto chainOf = [&](EdgeId e) {
+        return edgeShapes.empty() || edgeShapes[e] == kNoShape ? kNoShape : edgeShapes[e] & ~kReversedShape;
+    };
+    const std::uint32_t chain = chainOf(edge);
+    for (Neighbor back : neighbors(targets[edge])) {
+        if (back.to == from && chainOf(back.edge) == chain) return back.edge;
+    }
+    return kInvalidEdge;
+}
 
-    if (!j.contains("features") || !j["features"].is_array()) {
-        throw std::runtime_error("Invalid GeoJSON: missing 'features' array.");
+std::vector<Graph::Coordinate> Graph::pathGeometry(std::span<const NodeId> path, Profile profile) const {
+    std::vector<Coordinate> points;
+    if (path.empty()) return points;
+    points.push_back(location(path.front()));
+    for (std::size_t i = 1; i < path.size(); ++i) {
+        EdgeId edge = findEdge(path[i - 1], path[i], profile);
+        if (edge == kInvalidEdge) {
+            points.push_back(location(path[i]));
+            continue;
+        }
+        for (std::size_t j = 1; j < edgePointCount(edge); ++j) points.push_back(edgePoint(path[i - 1], edge, j));
     }
+    return points;
+}
 
-    // Helper lambda: converts a coordinate [lon, lat] -> "lat,lon"
-    auto coordToId = [&](double lon, double lat) -> std::string {
-        return std::to_string(lat) + "," + std::to_string(lon);
-    };
+std::vector<Graph::Coordinate> Graph::pathGeometry(const std::vector<std::string>& path, Profile profile) const {
+    std::vector<NodeId> ids;
+    ids.reserve(path.size());
+    for (const std::string& node : path) {
+        NodeId id = nodeId(node);
+        if (id != kInvalidNode) ids.push_back(id);
+    }
+    return pathGeometry(ids, profile);
+}
 
-    for (const auto& feature : j["features"]) {
-        if (!feature.contains("geometry") || feature["geometry"].is_null()) continue;
+namespace {
 
-        const auto& geom = feature["geometry"];
-        if (!geom.contains("type") || !geom.contains("coordinates")) continue;
+std::uint64_t mixKey(std::uint64_t key) { // splitmix64 finalizer
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ull;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebull;
+    key ^= key >> 31;
+    return key;
+}
 
-        const std::string type = geom["type"].get<std::string>();
+} // namespace
 
-// Case 1: LineString
-        if (type == "LineString") {
-            const auto& coords = geom["coordinates"];
-            if (!coords.is_array() || coords.size() < 2) continue;
+Graph::NodeId Graph::Builder::intern(double lat, double lon) {
+    if ((keys.size() + 1) * 2 > slotIds.size()) grow();
 
-            for (size_t i = 0; i + 1 < coords.size(); ++i) {
-                // Each coord is [lon, lat]
-                double lon1 = coords[i][0].get<double>();
-                double lat1 = coords[i][1].get<double>();
-                double lon2 = coords[i + 1][0].get<double>();
-                double lat2 = coords[i + 1][1].get<double>();
+    NodeKey key = coordinateKey(lat, lon);
+    std::size_t mask = slotIds.size() - 1;
+    for (std::size_t slot = mixKey(key) & mask;; slot = (slot + 1) & mask) {
+        if (slotIds[slot] == kInvalidNode) {
+            NodeId id = static_cast<NodeId>(keys.size());
+            slotKeys[slot] = key;
+            slotIds[slot] = id;
+            keys.push_back(key);
+            return id;
+        }
+        if (slotKeys[slot] == key) return slotIds[slot];
+    }
+}
 
-                std::string n1 = coordToId(lon1, lat1);
-                std::string n2 = coordToId(lon2, lat2);
+std::uint32_t Graph::Builder::internName(const std::string& name) {
+    if (name.empty()) return 0;
+    auto [it, inserted] = nameIds.emplace(name, static_cast<std::uint32_t>(names.size()));
+    if (inserted) names.push_back(name);
+    return it->second;
+}
+
+// Doubles the table (kept at most half full) and re-inserts every key
+void Graph::Builder::grow() {
+    std::size_t capacity = slotIds.empty() ? 1024 : slotIds.size() * 2;
+    slotKeys.assign(capacity, 0);
+    slotIds.assign(capacity, kInvalidNode);
+
+    std::size_t mask = capacity - 1;
+    for (NodeId id = 0; id < keys.size(); ++id) {
+        std::size_t slot = mixKey(keys[id]) & mask;
+        while (slotIds[slot] != kInvalidNode) slot = (slot + 1) & mask;
+        slotKeys[slot] = keys[id];
+        slotIds[slot] = id;
+    }
+}
 
-                // Store coordinates for A* heuristic later
-                nodeData[n1] = {lat1, lon1, ""};
-                nodeData[n2] = {lat2, lon2, ""};
+// Freezes the parsed edge list into CSR form, keeping each node's edges in insertion order
+void Graph::buildCsr(const std::vector<RawEdge>& rawEdges) {
+    std::vector<EdgeId> csrOffsets(nodeCount() + 1, 0);
+    for (const auto& edge : rawEdges) csrOffsets[edge.from + 1]++;
+    for (std::size_t i = 1; i < csrOffsets.size(); ++i) csrOffsets[i] += csrOffsets[i - 1];
+
+    std::vector<NodeId> csrTargets(rawEdges.size());
+    std::vector<double> csrWeights(rawEdges.size());
+    const bool shaped = std::any_of(rawEdges.begin(), rawEdges.end(),
+                                    [](const RawEdge& edge) { return edge.shape != kNoShape; });
+    std::vector<std::uint32_t> csrShapes(shaped ? rawEdges.size() : 0);
+    std::vector<EdgeAttributes> csrAttributes(rawEdges.size());
+    const bool named = std::any_of(rawEdges.begin(), rawEdges.end(), [](const RawEdge& edge) { return edge.name != 0; });
+    std::vector<std::uint32_t> csrNames(named ? rawEdges.size() : 0);
+
+    std::vector<EdgeId> cursor(csrOffsets.begin(), csrOffsets.end() - 1);
+    for (const auto& edge : rawEdges) {
+        EdgeId slot = cursor[edge.from]++;
+        csrTargets[slot] = edge.to;
+        csrWeights[slot] = edge.weight;
+        if (shaped) csrShapes[slot] = edge.shape;
+        csrAttributes[slot] = edge.attributes;
+        if (named) csrNames[slot] = edge.name;
+    }
 
-                double w = haversine(lat1, lon1, lat2, lon2);
+    offsets.assign(std::move(csrOffsets));
+    targets.assign(std::move(csrTargets));
+    weights.assign(std::move(csrWeights));
+    edgeShapes.assign(std::move(csrShapes));
+    attributes.assign(std::move(csrAttributes));
+    edgeNames.assign(std::move(csrNames));
+}
 
-                adjList[n1].push_back({n2, w});
-                adjList[n2].push_back({n1, w});
+// Welds near-duplicate nodes, then drops self-loops, repeated segments and any
+// node left without edges. Runs on the raw segments, before anything is weighed,
+// so every segment that survives is weighed between its final endpoints.
+void Graph::Builder::cleanup(double weldMeters, LoadStats& stats) {
+    const std::size_t n = keys.size();
+    std::vector<NodeId> target(n); // node each one is merged into (itself if kept)
+    for (NodeId v = 0; v < n; ++v) target[v] = v;
+
+    if (weldMeters > 0.0 && n > 0) {
+        // Spatial hash of weldMeters cells in local meters. A node joins the closest
+        // earlier survivor within range, so no weld cluster is wider than weldMeters.
+        const Coordinate origin = keyCoordinate(keys[0]);
+        const double metersPerDegree = kEarthRadius * M_PI / 180.0;
+        const double metersPerDegreeLon = metersPerDegree * std::cos(origin.lat * M_PI / 180.0);
+        auto cellKey = [](std::int64_t cx, std::int64_t cy) {
+            return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(cx)) << 32) | static_cast<std::uint32_t>(cy);
+        };
+
+        std::vector<double> xs(n), ys(n);
+        std::unordered_map<std::uint64_t, std::vector<NodeId>> survivors;
+        for (NodeId v = 0; v < n; ++v) {
+            const Coordinate c = keyCoordinate(keys[v]);
+            xs[v] = (c.lon - origin.lon) * metersPerDegreeLon;
+            ys[v] = (c.lat - origin.lat) * metersPerDegree;
+            const auto cx = static_cast<std::int64_t>(std::floor(xs[v] / weldMeters));
+            const auto cy = static_cast<std::int64_t>(std::floor(ys[v] / weldMeters));
+
+            NodeId closest = kInvalidNode;
+            double closestSquared = weldMeters * weldMeters;
+            for (std::int64_t dy = -1; dy <= 1; ++dy) {
+                for (std::int64_t dx = -1; dx <= 1; ++dx) {
+                    auto cell = survivors.find(cellKey(cx + dx, cy + dy));
+                    if (cell == survivors.end()) continue;
+                    for (NodeId u : cell->second) {
+                        const double d = (xs[u] - xs[v]) * (xs[u] - xs[v]) + (ys[u] - ys[v]) * (ys[u] - ys[v]);
+                        if (d < closestSquared || (d == closestSquared && closest == kInvalidNode)) {
+                            closestSquared = d;
+                            closest = u;
+                        }
+                    }
+                }
+            }
+            if (closest != kInvalidNode) {
+                target[v] = closest;
+                stats.weldedNodes++;
+            } else {
+                survivors[cellKey(cx, cy)].push_back(v);
             }
         }
-    
-// Case 2: MultiLineString
-        else if (type == "MultiLineString") {
-            const auto& lines = geom["coordinates"];
-            if (!lines.is_array()) continue;
+    }
+
+    // Segments are all straight at this point, so repeats weigh the same. Of two
+    // copies the one with more tags set (a name counts as one) stands; on a tie, the first.
+    auto tagCount = [](const RawEdge& edge) { return edge.attributes.taggedFields() + (edge.name != 0 ? 1 : 0); };
+    std::vector<RawEdge> kept;
+    kept.reserve(edges.size());
+    std::unordered_map<std::uint64_t, std::size_t> seen; // pair -> its forward edge in kept
+    seen.reserve(edges.size() / 2);
+    std::vector<bool> hasEdge(n, false);
+    for (std::size_t e = 0; e + 1 < edges.size(); e += 2) {
+        const NodeId a = target[edges[e].from];
+        const NodeId b = target[edges[e].to];
+        if (a == b) {
+            stats.selfLoops++;
+            continue;
+        }
+        const std::uint64_t pair = (static_cast<std::uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+        RawEdge forward = edges[e], backward = edges[e + 1];
+        forward.from = backward.to = a;
+        forward.to = backward.from = b;
+        auto [slot, added] = seen.try_emplace(pair, kept.size());
+        if (!added) {
+            stats.duplicateSegments++;
+            if (tagCount(forward) > tagCount(kept[slot->second])) {
+                kept[slot->second] = forward;
+                kept[slot->second + 1] = backward;
+            }
+            continue;
+        }
+        kept.push_back(forward);
+        kept.push_back(backward);
+        hasEdge[a] = hasEdge[b] = true;
+    }
+
+    std::vector<NodeId> newId(n, kInvalidNode);
+    std::vector<NodeKey> survivingKeys;
+    for (NodeId v = 0; v < n; ++v) {
+        if (target[v] != v) continue;
+        if (!hasEdge[v]) {
+            stats.isolatedNodes++;
+            continue;
+        }
+        newId[v] = static_cast<NodeId>(survivingKeys.size());
+        survivingKeys.push_back(keys[v]);
+    }
+    for (RawEdge& edge : kept) {
+        edge.from = newId[edge.from];
+        edge.to = newId[edge.to];
+    }
+    keys = std::move(survivingKeys);
+    edges = std::move(kept);
+    slotKeys = {}; // the intern table indexes the old IDs
+    slotIds = {};
+}
+
+// Every maximal run of degree-2 nodes becomes one edge between the nodes at
+// its ends (junctions and dead ends), weighing the sum of its segments and
+// carrying the run's points as shape. A run that would close on its own start
+// keeps its middle node, so no contracted edge is a loop.
+void Graph::Builder::contractChains() {
+    const std::size_t n = keys.size();
+
+    // Segment ends per node as a throwaway CSR; edges 2s and 2s + 1 are segment s
+    std::vector<EdgeId> first(n + 1, 0);
+    for (const RawEdge& edge : edges) first[edge.from + 1]++;
+    for (std::size_t i = 1; i < first.size(); ++i) first[i] += first[i - 1];
+    std::vector<EdgeId> incident(edges.size());
+    std::vector<EdgeId> cursor(first.begin(), first.end() - 1);
+    for (EdgeId e = 0; e < edges.size(); ++e) incident[cursor[edges[e].from]++] = e;
+
+    // A degree-2 node stays where the way's tags or name change, so every
+    // contracted edge carries one set of attributes
+    auto continues = [&](EdgeId in, EdgeId out) {
+        return edges[in].attributes == edges[out].attributes && edges[in].name == edges[out].name;
+    };
+    std::vector<bool> keep(n);
+    for (NodeId v = 0; v < n; ++v) {
+        keep[v] = first[v + 1] - first[v] != 2 || incident[first[v]] / 2 == incident[first[v] + 1] / 2 ||
+                  !continues(incident[first[v]] ^ 1, incident[first[v] + 1]);
+    }
+
+    std::vector<RawEdge> contracted;
+    std::vector<bool> used(edges.size() / 2, false);
+    std::vector<NodeId> interior;
+    std::vector<double> reach; // weight from the chain's start to each interior node
+    shapeOffsets.assign(1, 0);
+    shapePoints.clear();
+
+    auto emit = [&](const RawEdge& way, NodeId from, NodeId to, double weight, std::size_t begin, std::size_t end) {
+        std::uint32_t shape = kNoShape;
+        if (begin < end) {
+            shape = static_cast<std::uint32_t>(shapeOffsets.size() - 1);
+            for (std::size_t i = begin; i < end; ++i) shapePoints.push_back(keyCoordinate(keys[interior[i]]));
+            shapeOffsets.push_back(static_cast<std::uint32_t>(shapePoints.size()));
+        }
+        contracted.push_back({from, to, weight, shape, way.attributes, way.name});
+        contracted.push_back({to, from, weight, shape == kNoShape ? kNoShape : shape | kReversedShape,
+                              way.attributes.reversed(), way.name});
+    };
+
+    // Follows the chain leaving a kept node through edge e
+    auto walk = [&](EdgeId e) {
+        const RawEdge way = edges[e];
+        const NodeId from = way.from;
+        double weight = 0.0;
+        interior.clear();
+        reach.clear();
+        for (;;) {
+            used[e / 2] = true;
+            weight += edges[e].weight;
+            const NodeId v = edges[e].to;
+            if (keep[v]) {
+                if (v == from && !interior.empty()) {
+                    const std::size_t mid = interior.size() / 2;
+                    keep[interior[mid]] = true;
+                    emit(way, from, interior[mid], reach[mid], 0, mid);
+                    emit(way, interior[mid], v, weight - reach[mid], mid + 1, interior.size());
+                } else {
+                    emit(way, from, v, weight, 0, interior.size());
+                }
+                return;
+            }
+            interior.push_back(v);
+            reach.push_back(weight);
+            const EdgeId a = incident[first[v]];
+            e = a / 2 == e / 2 ? incident[first[v] + 1] : a; // leave through the other segment
+        }
+    };
+
+    for (NodeId u = 0; u < n; ++u) {
+        if (!keep[u]) continue;
+        for (EdgeId i = first[u]; i < first[u + 1]; ++i) {
+            if (!used[incident[i] / 2]) walk(incident[i]);
+        }
+    }
+    // Anything left is a closed ring of degree-2 nodes; one node of each anchors it
+    for (NodeId u = 0; u < n; ++u) {
+        if (keep[u] || used[incident[first[u]] / 2]) continue;
+        keep[u] = true;
+        walk(incident[first[u]]);
+    }
+
+    std::vector<NodeId> newId(n, kInvalidNode);
+    std::vector<NodeKey> kept;
+    for (NodeId v = 0; v < n; ++v) {
+        if (!keep[v]) continue;
+        newId[v] = static_cast<NodeId>(kept.size());
+        kept.push_back(keys[v]);
+    }
+    for (RawEdge& edge : contracted) {
+        edge.from = newId[edge.from];
+        edge.to = newId[edge.to];
+    }
+    keys = std::move(kept);
+    edges = std::move(contracted);
+    slotKeys = {}; // the intern table indexes the old IDs
+    slotIds = {};
+}
+
+namespace {
+
+// Position of (x, y) along a Hilbert curve filling a 2^16 x 2^16 grid
+std::uint64_t hilbertIndex(std::uint32_t x, std::uint32_t y) {
+    constexpr std::uint32_t n = 1u << 16;
+    std::uint64_t d = 0;
+    for (std::uint32_t s = n / 2; s > 0; s /= 2) {
+        std::uint32_t rx = (x & s) ? 1 : 0;
+        std::uint32_t ry = (y & s) ? 1 : 0;
+        d += std::uint64_t(s) * s * ((3 * rx) ^ ry);
+        if (ry == 0) { // rotate the quadrant so the curve stays continuous
+            if (rx == 1) {
+                x = n - 1 - x;
+                y = n - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return d;
+}
 
-            for (const auto& coords : lines) {
-                if (!coords.is_array() || coords.size() < 2) continue;
+} // namespace
+
+std::vector<Graph::NodeId> Graph::Builder::renumbering(NodeOrder order) const {
+    std::vector<NodeId> result(keys.size());
+    for (NodeId id = 0; id < result.size(); ++id) result[id] = id;
+    if (order == NodeOrder::Parse || keys.empty()) return result;
+
+    if (order == NodeOrder::Hilbert) {
+        double minLat = 90, maxLat = -90, minLon = 180, maxLon = -180;
+        for (NodeKey key : keys) {
+            Coordinate c = keyCoordinate(key);
+            minLat = std::min(minLat, c.lat);
+            maxLat = std::max(maxLat, c.lat);
+            minLon = std::min(minLon, c.lon);
+            maxLon = std::max(maxLon, c.lon);
+        }
+        const double scaleLat = 65535.0 / std::max(maxLat - minLat, 1e-9);
+        const double scaleLon = 65535.0 / std::max(maxLon - minLon, 1e-9);
+        std::vector<std::uint64_t> curve(keys.size());
+        for (NodeId id = 0; id < keys.size(); ++id) {
+            Coordinate c = keyCoordinate(keys[id]);
+            curve[id] = hilbertIndex(static_cast<std::uint32_t>((c.lon - minLon) * scaleLon),
+                                     static_cast<std::uint32_t>((c.lat - minLat) * scaleLat));
+        }
+        std::sort(result.begin(), result.end(), [&](NodeId a, NodeId b) {
+            return curve[a] != curve[b] ? curve[a] < curve[b] : keys[a] < keys[b];
+        });
+        return result;
+    }
 
-                for (size_t i = 0; i + 1 < coords.size(); ++i) {
-                    double lon1 = coords[i][0].get<double>();
-                    double lat1 = coords[i][1].get<double>();
-                    double lon2 = coords[i + 1][0].get<double>();
-                    double lat2 = coords[i + 1][1].get<double>();
+    // Bfs: one breadth-first sweep per component, over a throwaway CSR of the raw edges
+    std::vector<EdgeId> first(keys.size() + 1, 0);
+    for (const RawEdge& edge : edges) first[edge.from + 1]++;
+    for (std::size_t i = 1; i < first.size(); ++i) first[i] += first[i - 1];
+    std::vector<NodeId> adjacent(edges.size());
+    std::vector<EdgeId> cursor(first.begin(), first.end() - 1);
+    for (const RawEdge& edge : edges) adjacent[cursor[edge.from]++] = edge.to;
+
+    std::vector<bool> queued(keys.size(), false);
+    std::size_t head = 0, tail = 0;
+    for (NodeId root = 0; root < keys.size(); ++root) {
+        if (queued[root]) continue;
+        queued[root] = true;
+        result[tail++] = root;
+        while (head < tail) {
+            NodeId u = result[head++];
+            for (EdgeId e = first[u]; e < first[u + 1]; ++e) {
+                if (!queued[adjacent[e]]) {
+                    queued[adjacent[e]] = true;
+                    result[tail++] = adjacent[e];
+                }
+            }
+        }
+    }
+    return result;
+}
 
-                    std::string n1 = coordToId(lon1, lat1);
-                    std::string n2 = coordToId(lon2, lat2);
+// Packs the dictionary and adjacency into the immutable arrays the engines read
+void Graph::freeze(Builder&& builder, const LoadOptions& options) {
+    // Segments are weighed in blocks by the batch kernel rather than one haversine each,
+    // before contraction sums them into chains
+    {
+        std::vector<Geo::Point> points(builder.keys.size());
+        for (NodeId id = 0; id < points.size(); ++id) {
+            Coordinate c = keyCoordinate(builder.keys[id]);
+            points[id] = Geo::toPoint(c.lat, c.lon);
+        }
+        constexpr std::size_t kBlock = 256;
+        NodeId from[kBlock], to[kBlock];
+        double lengths[kBlock];
+        for (std::size_t begin = 0; begin < builder.edges.size(); begin += kBlock) {
+            const std::size_t count = std::min(kBlock, builder.edges.size() - begin);
+            for (std::size_t i = 0; i < count; ++i) {
+                from[i] = builder.edges[begin + i].from;
+                to[i] = builder.edges[begin + i].to;
+            }
+            GeoBatch::arcDistances(points.data(), from, to, count, lengths);
+            for (std::size_t i = 0; i < count; ++i) builder.edges[begin + i].weight = lengths[i];
+        }
+    }
+    if (options.contractChains) builder.contractChains();
+
+    if (options.order != NodeOrder::Parse) {
+        std::vector<NodeId> oldIds = builder.renumbering(options.order);
+        std::vector<NodeId> newId(oldIds.size());
+        std::vector<NodeKey> keys(oldIds.size());
+        for (NodeId id = 0; id < oldIds.size(); ++id) {
+            newId[oldIds[id]] = id;
+            keys[id] = builder.keys[oldIds[id]];
+        }
+        builder.keys = std::move(keys);
+        for (RawEdge& edge : builder.edges) {
+            edge.from = newId[edge.from];
+            edge.to = newId[edge.to];
+        }
+    }
 
-                    nodeData[n1] = {lat1, lon1, ""};
-                    nodeData[n2] = {lat2, lon2, ""};
+    // Coordinates come from the keys, so a node's location always matches its identity
+    std::vector<double> latValues(builder.keys.size()), lonValues(builder.keys.size());
+    for (NodeId id = 0; id < latValues.size(); ++id) {
+        const Coordinate c = keyCoordinate(builder.keys[id]);
+        latValues[id] = c.lat;
+        lonValues[id] = c.lon;
+    }
+    lats.assign(std::move(latValues));
+    lons.assign(std::move(lonValues));
+
+    std::vector<NodeId> byKey(builder.keys.size());
+    for (NodeId id = 0; id < byKey.size(); ++id) byKey[id] = id;
+    std::sort(byKey.begin(), byKey.end(), [&](NodeId a, NodeId b) {
+        return builder.keys[a] < builder.keys[b];
+    });
+    keyOrder.assign(std::move(byKey));
+    nodeKeys.assign(std::move(builder.keys));
+
+    buildCsr(builder.edges);
+    if (!edgeNames.empty()) {
+        std::vector<std::uint32_t> starts{0};
+        std::vector<char> chars;
+        for (const std::string& name : builder.names) {
+            chars.insert(chars.end(), name.begin(), name.end());
+            starts.push_back(static_cast<std::uint32_t>(chars.size()));
+        }
+        nameOffsets.assign(std::move(starts));
+        nameChars.assign(std::move(chars));
+    } else {
+        nameOffsets.reset();
+        nameChars.reset();
+    }
+    if (hasShapes()) {
+        shapeOffsets.assign(std::move(builder.shapeOffsets));
+        shapePoints.assign(std::move(builder.shapePoints));
+    } else {
+        shapeOffsets.reset();
+        shapePoints.reset();
+    }
+    mapping.reset(); // nothing views a previously loaded snapshot any more
+    buildIndexes(); // the same derived data as a snapshot load
+}
 
-                    double w = haversine(lat1, lon1, lat2, lon2);
+void Graph::cacheGeoPoints() {
+    cachedPoints.resize(nodeCount());
+    for (NodeId id : nodes()) cachedPoints[id] = Geo::toPoint(lats[id], lons[id]);
+}
 
-                    adjList[n1].push_back({n2, w});
-                    adjList[n2].push_back({n1, w}); // treat as undirected walkway
+// One breadth-first sweep per component over the CSR
+void Graph::labelComponents() {
+    constexpr ComponentId kUnlabeled = std::numeric_limits<ComponentId>::max();
+    componentLabels.assign(nodeCount(), kUnlabeled);
+    componentSizes.clear();
+    largest = 0;
+
+    std::vector<NodeId> queue(nodeCount());
+    for (NodeId root : nodes()) {
+        if (componentLabels[root] != kUnlabeled) continue;
+        const auto label = static_cast<ComponentId>(componentSizes.size());
+        std::size_t head = 0, tail = 0;
+        componentLabels[root] = label;
+        queue[tail++] = root;
+        while (head < tail) {
+            for (NodeId v : neighborIds(queue[head++])) {
+                if (componentLabels[v] == kUnlabeled) {
+                    componentLabels[v] = label;
+                    queue[tail++] = v;
                 }
             }
         }
+        componentSizes.push_back(static_cast<std::uint32_t>(tail));
+        if (tail > componentSizes[largest]) largest = label;
+    }
+}
 
-        // Ignore Polygons, MultiPolygons, Points, etc.
+// Prices every edge once per profile; closed edges stay infinite
+// even if their length is zero
+void Graph::weighProfiles() {
+    for (std::size_t p = 0; p < RoutingProfile::kCount; ++p) {
+        const auto profile = static_cast<Profile>(p);
+        std::vector<double>& costs = profileWeights[p];
+        costs.resize(edgeCount());
+        bool plain = true;
+        for (EdgeId e = 0; e < edgeCount(); ++e) {
+            const double factor = RoutingProfile::factor(profile, attributes[e]);
+            costs[e] = std::isinf(factor) ? factor : weights[e] * factor;
+            plain = plain && factor == 1.0;
+        }
+        if (plain) costs.clear(); // weightData() falls back to the lengths
     }
 }
 
+std::size_t Graph::profileWeightBytes() const {
+    std::size_t bytes = 0;
+    for (const std::vector<double>& costs : profileWeights) bytes += costs.size() * sizeof(double);
+    return bytes;
+}
+
+void Graph::buildIndexes() {
+    cacheGeoPoints();
+    labelComponents();
+    weighProfiles();
+    spatial.build(*this);
+}
+
+namespace {
+
+// Streaming GeoJSON reader: tracks where it is in the document and buffers only
+// the feature currently being read, handing each one off as soon as it closes.
+class GeoJsonSax : public nlohmann::json_sax<json> {
+    public:
+        struct Feature {
+            std::string geometryType;
+            std::vector<std::vector<Graph::Coordinate>> lines; // innermost coordinate runs, in order
+            EdgeAttributes attributes; // folded from "properties" as they stream past
+            std::string name;
+        };
+        using FeatureCallback = std::function<void(const Feature&)>;
 
+        explicit GeoJsonSax(FeatureCallback onFeature) : onFeature(std::move(onFeature)) {}
+
+        bool sawFeatures() const { return featuresFound; }
+
+        bool null() override { return true; }
+        bool boolean(bool val) override {
+            if (inProperties()) property(val ? "yes" : "no"); // e.g. covered: true
+            return true;
+        }
+        bool number_integer(number_integer_t val) override {
+            if (inProperties()) property(std::to_string(val)); // e.g. layer: -1
+            return number(static_cast<double>(val));
+        }
+        bool number_unsigned(number_unsigned_t val) override {
+            if (inProperties()) property(std::to_string(val)); // e.g. layer: 1
+            return number(static_cast<double>(val));
+        }
+        bool number_float(number_float_t val, const string_t& raw) override {
+            if (inProperties()) property(raw); // as written, e.g. incline: 8.5
+            return number(val);
+        }
+        bool binary(binary_t&) override { return true; }
+
+        bool string(string_t& val) override {
+            if (inGeometry() && stack.size() == 4 && stack[3].key == "type") {
+                feature.geometryType = val;
+            } else if (inProperties()) {
+                property(val);
+            }
+            return true;
+        }
+
+        bool start_object(std::size_t) override {
+            stack.push_back({true, {}});
+            if (inFeatureList() && stack.size() == 3) {
+                feature.geometryType.clear();
+                feature.lines.clear();
+                feature.attributes = {};
+                feature.name.clear();
+            }
+            if ((inFeatureList() && stack.size() == 3) || (inGeometry() && stack.size() == 4)) {
+                // Nothing half-read may carry over into the next feature or geometry
+                coordFrames.clear();
+                currentLine.clear();
+            }
+            return true;
+        }
+
+        bool key(string_t& val) override {
+            stack.back().key = val;
+            return true;
+        }
+
+        bool end_object() override {
+            if (inFeatureList() && stack.size() == 3) {
+                onFeature(feature);
+            }
+            stack.pop_back();
+            return true;
+        }
 
+        bool start_array(std::size_t) override {
+            if (stack.size() == 1 && stack[0].isObject && stack[0].key == "features") {
+                featuresFound = true;
+            }
+            stack.push_back({false, {}});
+            if (inCoordinates()) {
+                coordFrames.push_back({});
+            }
+            return true;
+        }
+
+        bool end_array() override {
+            if (inCoordinates()) {
+                CoordFrame frame = coordFrames.back();
+                coordFrames.pop_back();
+                if (frame.numbers >= 2 && !coordFrames.empty()) {
+                    // [lon, lat(, alt)] position inside a run of them; a Point's lone position is skipped
+                    currentLine.push_back({frame.values[1], frame.values[0]});
+                    coordFrames.back().holdsPositions = true;
+                } else if (frame.holdsPositions) {
+                    feature.lines.push_back(std::move(currentLine));
+                    currentLine.clear();
+                }
+            }
+            stack.pop_back();
+            return true;
+        }
+
+        bool parse_error(std::size_t position, const std::string&, const nlohmann::detail::exception& ex) override {
+            throw std::runtime_error("Invalid GeoJSON at byte " + std::to_string(position) + ": " + ex.what());
+        }
+
+    private:
+        struct Container {
+            bool isObject;
+            std::string key; // most recent key, for objects
+        };
+        struct CoordFrame {
+            int numbers = 0;
+            double values[2] = {0.0, 0.0};
+            bool holdsPositions = false;
+        };
+
+        // root{ "features": [ {feature} ] }
+        bool inFeatureList() const {
+            return stack.size() >= 2 && stack[0].isObject && stack[0].key == "features" && !stack[1].isObject;
+        }
+        // feature{ "geometry": {...} }
+        bool inGeometry() const {
+            return inFeatureList() && stack.size() >= 4 && stack[2].isObject && stack[2].key == "geometry" &&
+                   stack[3].isObject;
+        }
+        // feature{ "properties": { key: value } }, for a value directly inside properties
+        bool inProperties() const {
+            return inFeatureList() && stack.size() == 4 && stack[2].isObject && stack[2].key == "properties" &&
+                   stack[3].isObject;
+        }
+        // geometry{ "coordinates": [...] }, called after the current array was pushed
+        bool inCoordinates() const {
+            return inGeometry() && stack.size() >= 5 && stack[3].key == "coordinates";
+        }
+
+        // Every scalar under "properties" is read as the tag's text
+        void property(const std::string& value) {
+            if (stack[3].key == "name") {
+                feature.name = value;
+            } else {
+                feature.attributes.applyTag(stack[3].key, value);
+            }
+        }
+
+        bool number(double val) {
+            if (inCoordinates() && !coordFrames.empty()) {
+                CoordFrame& frame = coordFrames.back();
+                if (frame.numbers < 2) frame.values[frame.numbers] = val;
+                frame.numbers++;
+            }
+            return true;
+        }
+
+        FeatureCallback onFeature;
+        std::vector<Container> stack;
+        std::vector<CoordFrame> coordFrames;
+        std::vector<Graph::Coordinate> currentLine;
+        Feature feature;
+        bool featuresFound = false;
+};
+
+} // namespace
+
+void Graph::parseFile(const std::string& filename, const LoadOptions& options) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    std::ifstream inFile(filename, std::ios::binary);
+    if (!inFile.is_open()) {
+        throw std::runtime_error("Could not open file: " + filename);
+    }
+
+    Builder builder;
+    LoadStats stats;
+
+    // Adds an undirected edge for each consecutive pair of points in one coordinate run
+    auto addLine = [&](const std::vector<Coordinate>& coords, EdgeAttributes attributes, const std::string& wayName) {
+        if (coords.size() < 2) return;
+        const std::uint32_t name = builder.internName(wayName);
+
+        for (size_t i = 0; i + 1 < coords.size(); ++i) {
+            NodeId n1 = builder.intern(coords[i].lat, coords[i].lon);
+            NodeId n2 = builder.intern(coords[i + 1].lat, coords[i + 1].lon);
+
+            // Weighed in freeze(), once cleanup has settled the endpoints
+            builder.edges.push_back({n1, n2, 0.0, kNoShape, attributes, name});
+            builder.edges.push_back({n2, n1, 0.0, kNoShape, attributes.reversed(), name}); // treat as undirected walkway
+            stats.segments++;
+        }
+    };
+
+    GeoJsonSax sax([&](const GeoJsonSax::Feature& feature) {
+        stats.features++;
+
+// Case 1: LineString
+        if (feature.geometryType == "LineString") {
+            if (feature.lines.size() == 1) addLine(feature.lines.front(), feature.attributes, feature.name);
+        }
+
+// Case 2: MultiLineString
+        else if (feature.geometryType == "MultiLineString") {
+            for (const auto& coords : feature.lines) addLine(coords, feature.attributes, feature.name);
+        }
+
+        // Ignore Polygons, MultiPolygons, Points, etc.
+    });
+
+    json::sax_parse(inFile, &sax);
+
+    if (!sax.sawFeatures()) {
+        throw std::runtime_error("Invalid GeoJSON: missing 'features' array.");
+    }
+
+    inFile.clear();
+    stats.bytes = static_cast<std::uint64_t>(inFile.tellg());
+    stats.parseMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - startTime).count();
+
+    builder.cleanup(options.weldMeters, stats);
+    stats.parsedNodes = builder.keys.size();
+    stats.parsedEdges = builder.edges.size();
+    freeze(std::move(builder), options);
+    lastLoad = stats;
+}
@@ -1,40 +1,327 @@
 #ifndef GRAPH_H
 #define GRAPH_H
 
+#include <array>
 #include <iostream>
 #include <vector>
 #include <unordered_map>
 #include <string>
-
-class ShortestPathBase; // so we can use nodeData
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <span>
+#include <ranges>
+#include <cstddef>
+#include <string_view>
+#include "EdgeAttributes.h"
+#include "FrozenArray.h"
+#include "Geo.h"
+#include "RoutingProfile.h"
+#include "SpatialIndex.h"
 
 class Graph {
     public:
-        const double kEarthRadius = 6371000; // meters
+        static constexpr double kEarthRadius = Geo::kEarthRadius; // meters
+
+        // Dense integer node handle used by the search engines. The "lat,lon"
+        // strings are only translated at the API boundary.
+        using NodeId = std::uint32_t;
+        struct Coordinate {
+            double lat;
+            double lon;
+        };
+        using EdgeId = std::uint32_t;
+        static constexpr NodeId kInvalidNode = std::numeric_limits<NodeId>::max();
+        static constexpr EdgeId kInvalidEdge = SpatialIndex::kInvalidEdge;
+        using Profile = RoutingProfile::Profile;
+
+        // Exact node identity: lat and lon as 1e-7 degree fixed point, packed into 64 bits
+        // (latE7 in the high word). OSM stores coordinates at this precision.
+        using NodeKey = std::uint64_t;
+        static constexpr double kKeyScale = 1e7;
+        static NodeKey coordinateKey(double lat, double lon);
+        static Coordinate keyCoordinate(NodeKey key);
+        static std::string formatKey(NodeKey key);                   // "lat,lon" with 7 decimals
+        static bool parseKey(const std::string& node, NodeKey& key); // accepts any "lat,lon" text
+
         struct NodeLocation {
             double lat;
             double lon;
             std::string name;
         };
         Graph() = default;
-    
-        void loadFromFile(const std::string& filename);
+
+        // How node IDs are assigned after parsing. Hilbert (the default) numbers
+        // nodes along a Hilbert curve over their coordinates and Bfs in
+        // breadth-first order of the walkway network, so nodes a search reaches
+        // together sit on neighboring cache lines; Parse keeps first-seen order.
+        enum class NodeOrder { Parse, Hilbert, Bfs };
+
+        struct LoadOptions {
+            NodeOrder order = NodeOrder::Hilbert;
+            // Collapse runs of degree-2 shape points into single edges that keep
+            // the points as geometry. Only junctions and dead ends stay routable
+            // nodes, so names of interior shape points no longer resolve; snap
+            // coordinates onto edges to route from anywhere along a way.
+            bool contractChains = false;
+            // Parse-time cleanup always drops zero-length self-loops and repeated
+            // segments (overlapping ways); nodes closer than weldMeters are also
+            // merged into the first of them seen, joining ways that miss each
+            // other by a hair. 0 keeps every distinct coordinate.
+            double weldMeters = 0.0;
+        };
+
+        // Loads a graph once so any number of engines (and threads) can share it read-only
+        static std::shared_ptr<const Graph> fromFile(const std::string& filename, NodeOrder order = NodeOrder::Hilbert);
+        static std::shared_ptr<const Graph> fromFile(const std::string& filename, const LoadOptions& options);
+        static std::shared_ptr<const Graph> fromSnapshot(const std::string& filename, bool verifyChecksums = true);
+
+        void loadFromFile(const std::string& filename, NodeOrder order = NodeOrder::Hilbert);
+        void loadFromFile(const std::string& filename, const LoadOptions& options);
+
+        // Versioned binary snapshot (GraphSnapshot.cpp). Loading maps the file read-only,
+        // so processes on one host share the page cache instead of each parsing GeoJSON.
+        // verifyChecksums=false skips only the checksums; offsets and indexes between
+        // sections are always range-checked.
+        void saveSnapshot(const std::string& filename) const;
+        void loadSnapshot(const std::string& filename, bool verifyChecksums = true);
+        bool isMapped() const { return mapping != nullptr; }
+
+        // Figures from the most recent GeoJSON load (zeroed for snapshot loads)
+        struct LoadStats {
+            std::uint64_t bytes = 0;
+            std::uint64_t features = 0;
+            std::uint64_t segments = 0;
+            std::uint64_t parsedNodes = 0; // after cleanup, before chain contraction
+            std::uint64_t parsedEdges = 0;
+            std::uint64_t selfLoops = 0;         // segments dropped by cleanup
+            std::uint64_t duplicateSegments = 0;
+            std::uint64_t weldedNodes = 0;       // nodes merged into a neighbor within weldMeters
+            std::uint64_t isolatedNodes = 0;     // nodes left without edges, dropped
+            double parseMs = 0.0;
+
+            double throughputMBps() const { return parseMs > 0.0 ? (bytes / 1e6) / (parseMs / 1e3) : 0.0; }
+        };
+        const LoadStats& loadStats() const { return lastLoad; }
         bool containsNode(const std::string& node) const;
 
+        // Copying convenience wrappers; hot paths should use neighbors()/nodes() below
         NodeLocation getNodeLocation(const std::string& nodeId) const;
         std::vector<std::pair<std::string, double>> getNeighbors(const std::string& node) const;
         std::unordered_map<std::string, std::vector<std::pair<std::string, double>>> getList() const;
-   
+
+        // Integer-ID core (CSR). Edges of node u are [edgeBegin(u), edgeEnd(u)).
+        std::size_t nodeCount() const { return lats.size(); }
+        std::size_t edgeCount() const { return targets.size(); }
+
+        NodeId nodeId(const std::string& node) const; // kInvalidNode if absent
+        NodeId nodeId(NodeKey key) const;
+        NodeKey nodeKey(NodeId id) const { return nodeKeys[id]; }
+        std::string nodeName(NodeId id) const { return formatKey(nodeKeys[id]); } // built on demand
+        Coordinate location(NodeId id) const { return {lats[id], lons[id]}; }
+        const Geo::Point& geoPoint(NodeId id) const { return cachedPoints[id]; } // cached radians / cos / xyz
+        std::span<const Geo::Point> geoPoints() const { return cachedPoints; }   // indexed by NodeId, for GeoBatch
+
+        EdgeId edgeBegin(NodeId u) const { return offsets[u]; }
+        EdgeId edgeEnd(NodeId u) const { return offsets[u + 1]; }
+        NodeId edgeTarget(EdgeId e) const { return targets[e]; }
+        double edgeWeight(EdgeId e) const { return weights[e]; }
+        EdgeAttributes edgeAttributes(EdgeId e) const { return attributes[e]; } // tags of the way, as walked
+        std::string_view edgeName(EdgeId e) const; // "name" of the way, empty if it had none
+
+        // Edge costs under a routing profile, priced from the edge tags at load
+        // time, so switching profiles per query costs nothing. A profile that
+        // prices every edge at its length (walking on a graph with no closed
+        // ways) reads the weights above instead of keeping a copy.
+        double edgeWeight(EdgeId e, Profile profile) const { return weightData(profile)[e]; }
+        std::span<const double> edgeWeights(Profile profile) const { return {weightData(profile), edgeCount()}; }
+        std::size_t profileWeightBytes() const; // held by the profiles' own arrays
+
+        // Zero-copy views into the CSR arrays
+        struct Neighbor {
+            NodeId to;
+            double weight;
+            EdgeId edge;
+        };
+
+        class NeighborRange {
+            public:
+                class iterator {
+                    public:
+                        using value_type = Neighbor;
+                        using difference_type = std::ptrdiff_t;
+
+                        iterator() = default;
+                        iterator(const Graph* g, const double* w, EdgeId e) : g(g), w(w), e(e) {}
+
+                        Neighbor operator*() const { return {g->targets[e], w[e], e}; }
+                        iterator& operator++() { ++e; return *this; }
+                        iterator operator++(int) { iterator old = *this; ++e; return old; }
+                        bool operator==(const iterator& other) const { return e == other.e; }
+                        bool operator!=(const iterator& other) const { return e != other.e; }
+
+                    private:
+                        const Graph* g = nullptr;
+                        const double* w = nullptr; // the profile's weights
+                        EdgeId e = 0;
+                };
+
+                NeighborRange(const Graph* g, const double* w, EdgeId first, EdgeId last)
+                    : g(g), w(w), first(first), last(last) {}
+
+                iterator begin() const { return {g, w, first}; }
+                iterator end() const { return {g, w, last}; }
+                std::size_t size() const { return last - first; }
+                bool empty() const { return first == last; }
+
+            private:
+                const Graph* g;
+                const double* w;
+                EdgeId first;
+                EdgeId last;
+        };
+
+        NeighborRange neighbors(NodeId u) const { return {this, weights.data(), offsets[u], offsets[u + 1]}; }
+        NeighborRange neighbors(NodeId u, Profile profile) const {
+            return {this, weightData(profile), offsets[u], offsets[u + 1]};
+        }
+        std::span<const NodeId> neighborIds(NodeId u) const {
+            return {targets.data() + offsets[u], targets.data() + offsets[u + 1]};
+        }
+        std::span<const double> neighborWeights(NodeId u) const {
+            return {weights.data() + offsets[u], weights.data() + offsets[u + 1]};
+        }
+        std::span<const double> neighborWeights(NodeId u, Profile profile) const {
+            return {weightData(profile) + offsets[u], weightData(profile) + offsets[u + 1]};
+        }
+
+        // All node IDs, 0 .. nodeCount()-1, without materializing anything
+        auto nodes() const { return std::views::iota(NodeId{0}, static_cast<NodeId>(nodeCount())); }
+
+        // Connected components, labeled once per load: two nodes are mutually
+        // reachable exactly when their labels match (edges are undirected)
+        using ComponentId = std::uint32_t;
+        ComponentId componentOf(NodeId id) const { return componentLabels[id]; }
+        std::size_t componentCount() const { return componentSizes.size(); }
+        std::size_t componentSize(ComponentId c) const { return componentSizes[c]; }
+        ComponentId largestComponent() const { return largest; }
+        bool connected(NodeId a, NodeId b) const { return componentLabels[a] == componentLabels[b]; }
+
+        // Snapping arbitrary coordinates onto the network, via a grid built at load time
+        using EdgePoint = SpatialIndex::EdgePoint;
+        NodeId nearestNode(double lat, double lon) const { return spatial.nearestNode(*this, lat, lon); }
+        EdgePoint nearestEdgePoint(double lat, double lon) const { return spatial.nearestEdgePoint(*this, lat, lon); }
+        EdgePoint nearestEdgePoint(double lat, double lon, Profile profile) const { // skips edges closed to it
+            return spatial.nearestEdgePoint(*this, lat, lon, profile);
+        }
+        bool isValid(const EdgePoint& point) const {
+            return point.from < nodeCount() && point.edge >= edgeBegin(point.from) && point.edge < edgeEnd(point.from) &&
+                   point.fraction >= 0.0 && point.fraction <= 1.0;
+        }
+
+        // Edge polylines: from, any shape points kept by chain contraction, then
+        // edgeTarget(edge). Without contraction every edge is a single segment.
+        bool hasShapes() const { return !edgeShapes.empty(); }
+        std::size_t edgePointCount(EdgeId edge) const;
+        Coordinate edgePoint(NodeId from, EdgeId edge, std::size_t i) const; // i < edgePointCount(edge)
+
+        // Points along edge (from -> edgeTarget(edge)) between two fractions of its
+        // length, in that order (begin > end walks it backwards)
+        std::vector<Coordinate> edgeGeometry(NodeId from, EdgeId edge, double begin = 0.0, double end = 1.0) const;
+
+        // Cheapest edge from -> to under the profile, kInvalidEdge if they are not adjacent.
+        // Contraction can leave parallel edges, so ask with the profile the path was searched in.
+        EdgeId findEdge(NodeId from, NodeId to, Profile profile = Profile::Walking) const;
+        // The same edge walked back (edgeTarget(edge) -> from over the same polyline); chain
+        // contraction can leave several edges between one pair of nodes, so this is not findEdge
+        EdgeId reverseEdge(NodeId from, EdgeId edge) const;
+        // Full polyline of a node path (e.g. PathResult::path), expanding contracted chains
+        std::vector<Coordinate> pathGeometry(std::span<const NodeId> path, Profile profile = Profile::Walking) const;
+        std::vector<Coordinate> pathGeometry(const std::vector<std::string>& path,
+                                             Profile profile = Profile::Walking) const;
+
     private:
-        friend class ShortestPathBase;
-        
-        double deg2rad(double deg);
-        double haversine(double lat1, double lon1, double lat2, double lon2);
-
-        void parseFile(const std::string& filename);
-       
-        std::unordered_map<std::string, std::vector<std::pair<std::string, double>>> adjList;
-        std::unordered_map<std::string, NodeLocation> nodeData;
-        // Key is the starting Node, and value is an array of Nodes to visit with the weight
+        struct RawEdge {
+            NodeId from;
+            NodeId to;
+            double weight;
+            std::uint32_t shape = kNoShape; // see edgeShapes
+            EdgeAttributes attributes = {};
+            std::uint32_t name = 0;         // index into Builder::names
+        };
+
+        // Parse-time state; discarded once the graph is frozen
+        struct Builder {
+            // Open-addressing NodeKey -> NodeId table used to de-duplicate endpoints
+            std::vector<NodeKey> slotKeys;
+            std::vector<NodeId> slotIds;
+            std::vector<NodeKey> keys;
+            std::vector<RawEdge> edges; // undirected segments as consecutive (u, v), (v, u) pairs
+            std::vector<std::uint32_t> shapeOffsets{0};
+            std::vector<Coordinate> shapePoints;
+            std::vector<std::string> names{""};
+            std::unordered_map<std::string, std::uint32_t> nameIds;
+
+            NodeId intern(double lat, double lon);
+            std::uint32_t internName(const std::string& name);
+            void grow();
+            void cleanup(double weldMeters, LoadStats& stats);
+            void contractChains();
+            std::vector<NodeId> renumbering(NodeOrder order) const; // old IDs in their new order
+        };
+
+        void parseFile(const std::string& filename, const LoadOptions& options);
+        void freeze(Builder&& builder, const LoadOptions& options);
+        void buildCsr(const std::vector<RawEdge>& rawEdges);
+        void cacheGeoPoints();
+        void labelComponents();
+        void weighProfiles();
+        const double* weightData(Profile profile) const {
+            const std::vector<double>& costs = profileWeights[static_cast<std::size_t>(profile)];
+            return costs.empty() ? weights.data() : costs.data();
+        }
+        void buildIndexes(); // derived per-node data, rebuilt after every load
+
+        // Key <-> ID dictionary, only consulted at the API boundary.
+        // keyOrder lists IDs sorted by key for lookup.
+        FrozenArray<NodeKey> nodeKeys;
+        FrozenArray<NodeId> keyOrder;
+        FrozenArray<double> lats; // per node, as two arrays so a scan over one axis reads only that axis
+        FrozenArray<double> lons;
+
+        // Frozen adjacency: offsets has nodeCount()+1 entries, targets/weights one per directed edge
+        FrozenArray<EdgeId> offsets;
+        FrozenArray<NodeId> targets;
+        FrozenArray<double> weights;
+        FrozenArray<EdgeAttributes> attributes; // per edge, beside weights for the relaxation loop
+
+        // Interned way names: edgeNames has one entry per edge (none at all if no
+        // way was named); name 0 is the empty name. nameOffsets is CSR into nameChars.
+        FrozenArray<std::uint32_t> edgeNames;
+        FrozenArray<std::uint32_t> nameOffsets;
+        FrozenArray<char> nameChars;
+
+        // Contracted geometry. edgeShapes holds one entry per edge (none at all
+        // without contraction): kNoShape for a plain segment, else the chain whose
+        // interior points it follows, with kReversedShape set when it walks them
+        // backwards. Both directions of a chain share one run of shapePoints.
+        static constexpr std::uint32_t kNoShape = std::numeric_limits<std::uint32_t>::max();
+        static constexpr std::uint32_t kReversedShape = 1u << 31;
+        FrozenArray<std::uint32_t> edgeShapes;
+        FrozenArray<std::uint32_t> shapeOffsets; // chains + 1 entries, CSR into shapePoints
+        FrozenArray<Coordinate> shapePoints;
+
+        // Derived from the arrays above by buildIndexes(), never persisted
+        std::vector<Geo::Point> cachedPoints;
+        std::array<std::vector<double>, RoutingProfile::kCount> profileWeights; // per edge; empty where it would equal weights
+        std::vector<ComponentId> componentLabels; // per node
+        std::vector<std::uint32_t> componentSizes; // per component, labels numbered by lowest node ID
+        ComponentId largest = 0;
+        SpatialIndex spatial;
+
+        LoadStats lastLoad;
+
+        // Keeps a mapped snapshot alive while the arrays above view into it
+        std::shared_ptr<const void> mapping;
 };
 #endif
@@ -0,0 +1,301 @@
+#include "Graph.h"
+#include "Checksum.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Snapshot layout (all integers native little-endian):
+//   Header | SectionEntry[sectionCount] | sections, each aligned to kAlignment
+// Every section carries an FNV-1a checksum; the section table has its own.
+// Bump kVersion whenever a section is added, removed or changes meaning.
+
+namespace {
+
+constexpr char kMagic[8] = {'C', 'P', 'F', 'G', 'R', 'A', 'P', 'H'};
+constexpr std::uint32_t kVersion = 5;
+constexpr std::uint32_t kEndianTag = 0x01020304;
+constexpr std::uint64_t kAlignment = 64;
+
+enum SectionId : std::uint32_t {
+    kLatitudes = 1,
+    kOffsets,
+    kTargets,
+    kWeights,
+    kNodeKeys,
+    kKeyOrder,
+    kEdgeShapes,   // empty unless chains were contracted
+    kShapeOffsets,
+    kShapePoints,
+    kEdgeAttributes,
+    kEdgeNames,    // empty unless some way was named
+    kNameOffsets,
+    kNameChars,
+    kLongitudes,
+};
+
+constexpr std::uint64_t kAnyCount = ~std::uint64_t{0};
+
+struct Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t endianTag;
+    std::uint64_t nodeCount;
+    std::uint64_t edgeCount;
+    std::uint32_t sectionCount;
+    std::uint32_t reserved;
+    std::uint64_t tableChecksum;
+};
+
+struct SectionEntry {
+    std::uint32_t id;
+    std::uint32_t elementSize;
+    std::uint64_t offset;
+    std::uint64_t bytes;
+    std::uint64_t checksum;
+};
+
+static_assert(sizeof(Header) == 48, "snapshot header layout changed");
+static_assert(sizeof(SectionEntry) == 32, "snapshot section layout changed");
+
+bool nonDecreasing(const std::uint32_t* values, std::uint64_t count) {
+    for (std::uint64_t i = 1; i < count; ++i) {
+        if (values[i] < values[i - 1]) return false;
+    }
+    return true;
+}
+
+bool allBelow(const std::uint32_t* values, std::uint64_t count, std::uint64_t limit) {
+    for (std::uint64_t i = 0; i < count; ++i) {
+        if (values[i] >= limit) return false;
+    }
+    return true;
+}
+
+std::uint64_t alignUp(std::uint64_t value) {
+    return (value + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+struct PendingSection {
+    std::uint32_t id;
+    std::uint32_t elementSize;
+    const void* data;
+    std::uint64_t bytes;
+};
+
+template <typename T>
+PendingSection section(std::uint32_t id, const FrozenArray<T>& array) {
+    return {id, static_cast<std::uint32_t>(sizeof(T)), array.data(), array.size() * sizeof(T)};
+}
+
+} // namespace
+
+void Graph::saveSnapshot(const std::string& filename) const {
+    static_assert(sizeof(Coordinate) == 2 * sizeof(double), "Coordinate must be tightly packed");
+
+    std::vector<PendingSection> pending = {
+        section(kLatitudes, lats),
+        section(kLongitudes, lons),
+        section(kOffsets, offsets),
+        section(kTargets, targets),
+        section(kWeights, weights),
+        section(kNodeKeys, nodeKeys),
+        section(kKeyOrder, keyOrder),
+        section(kEdgeShapes, edgeShapes),
+        section(kShapeOffsets, shapeOffsets),
+        section(kShapePoints, shapePoints),
+        section(kEdgeAttributes, attributes),
+        section(kEdgeNames, edgeNames),
+        section(kNameOffsets, nameOffsets),
+        section(kNameChars, nameChars),
+    };
+
+    std::vector<SectionEntry> table;
+    std::uint64_t cursor = alignUp(sizeof(Header) + pending.size() * sizeof(SectionEntry));
+    for (const auto& sec : pending) {
+        table.push_back({sec.id, sec.elementSize, cursor, sec.bytes, fnv1a(sec.data, sec.bytes)});
+        cursor = alignUp(cursor + sec.bytes);
+    }
+
+    Header header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.endianTag = kEndianTag;
+    header.nodeCount = nodeCount();
+    header.edgeCount = edgeCount();
+    header.sectionCount = static_cast<std::uint32_t>(table.size());
+    header.tableChecksum = fnv1a(table.data(), table.size() * sizeof(SectionEntry));
+
+    // Write beside the target and rename, so processes mapping the old file never see a partial one
+    const std::string tmpName = filename + ".tmp";
+    {
+        std::ofstream out(tmpName, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            throw std::runtime_error("Could not open file for writing: " + tmpName);
+        }
+
+        auto padTo = [&](std::uint64_t position) {
+            static const char zeros[kAlignment] = {};
+            std::uint64_t current = static_cast<std::uint64_t>(out.tellp());
+            out.write(zeros, static_cast<std::streamsize>(position - current));
+        };
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(table.data()),
+                  static_cast<std::streamsize>(table.size() * sizeof(SectionEntry)));
+        for (std::size_t i = 0; i < pending.size(); ++i) {
+            padTo(table[i].offset);
+            out.write(static_cast<const char*>(pending[i].data), static_cast<std::streamsize>(pending[i].bytes));
+        }
+        padTo(cursor);
+
+        if (!out) {
+            throw std::runtime_error("Failed writing snapshot: " + tmpName);
+        }
+    }
+    if (std::rename(tmpName.c_str(), filename.c_str()) != 0) {
+        std::remove(tmpName.c_str());
+        throw std::runtime_error("Could not move snapshot into place: " + filename);
+    }
+}
+
+void Graph::loadSnapshot(const std::string& filename, bool verifyChecksums) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Could not open file: " + filename);
+    }
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(Header))) {
+        ::close(fd);
+        throw std::runtime_error("Invalid snapshot: file too small: " + filename);
+    }
+    const std::size_t fileSize = static_cast<std::size_t>(st.st_size);
+    void* base = ::mmap(nullptr, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); // the mapping keeps its own reference to the file
+    if (base == MAP_FAILED) {
+        throw std::runtime_error("Could not mmap snapshot: " + filename);
+    }
+    std::shared_ptr<const void> region(base, [fileSize](const void* p) {
+        ::munmap(const_cast<void*>(p), fileSize);
+    });
+
+    const auto* bytes = static_cast<const unsigned char*>(base);
+    Header header;
+    std::memcpy(&header, bytes, sizeof(header));
+
+    auto fail = [&](const std::string& why) {
+        throw std::runtime_error("Invalid snapshot (" + why + "): " + filename);
+    };
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) fail("bad magic");
+    if (header.endianTag != kEndianTag) fail("byte order mismatch");
+    if (header.version != kVersion) fail("unsupported version " + std::to_string(header.version));
+
+    const std::uint64_t tableBytes = static_cast<std::uint64_t>(header.sectionCount) * sizeof(SectionEntry);
+    if (sizeof(Header) + tableBytes > fileSize) fail("truncated section table");
+    const auto* table = reinterpret_cast<const SectionEntry*>(bytes + sizeof(Header));
+    if (fnv1a(table, tableBytes) != header.tableChecksum) fail("section table checksum");
+
+    // Locates a section and checks it against the expected element size and count (if not kAnyCount)
+    auto find = [&](std::uint32_t id, std::size_t elementSize, std::uint64_t expectedCount) {
+        for (std::uint32_t i = 0; i < header.sectionCount; ++i) {
+            const SectionEntry& sec = table[i];
+            if (sec.id != id) continue;
+            if (sec.elementSize != elementSize) fail("element size of section " + std::to_string(id));
+            if (sec.offset % kAlignment != 0 || sec.bytes > fileSize || sec.offset > fileSize - sec.bytes) {
+                fail("bounds of section " + std::to_string(id));
+            }
+            if (expectedCount == kAnyCount ? sec.bytes % elementSize != 0
+                                           : expectedCount > sec.bytes / elementSize ||
+                                             sec.bytes != expectedCount * elementSize) {
+                fail("size of section " + std::to_string(id));
+            }
+            if (verifyChecksums && fnv1a(bytes + sec.offset, sec.bytes) != sec.checksum) {
+                fail("checksum of section " + std::to_string(id));
+            }
+            return std::make_pair(static_cast<const void*>(bytes + sec.offset), sec.bytes / elementSize);
+        }
+        fail("missing section " + std::to_string(id));
+        return std::make_pair(static_cast<const void*>(nullptr), std::uint64_t{0});
+    };
+
+    const std::uint64_t n = header.nodeCount;
+    const std::uint64_t m = header.edgeCount;
+
+    auto [latData, latCount] = find(kLatitudes, sizeof(double), n);
+    auto [lonData, lonCount] = find(kLongitudes, sizeof(double), n);
+    auto [offsetData, offsetCount] = find(kOffsets, sizeof(EdgeId), n + 1);
+    auto [targetData, targetCount] = find(kTargets, sizeof(NodeId), m);
+    auto [weightData, weightCount] = find(kWeights, sizeof(double), m);
+    auto [keyData, keyCount] = find(kNodeKeys, sizeof(NodeKey), n);
+    auto [keyOrderData, keyOrderCount] = find(kKeyOrder, sizeof(NodeId), n);
+
+    auto [edgeShapeData, edgeShapeCount] = find(kEdgeShapes, sizeof(std::uint32_t), kAnyCount);
+    auto [shapeOffsetData, shapeOffsetCount] = find(kShapeOffsets, sizeof(std::uint32_t), kAnyCount);
+    auto [shapePointData, shapePointCount] = find(kShapePoints, sizeof(Coordinate), kAnyCount);
+    auto [attributeData, attributeCount] = find(kEdgeAttributes, sizeof(EdgeAttributes), m);
+    auto [edgeNameData, edgeNameCount] = find(kEdgeNames, sizeof(std::uint32_t), kAnyCount);
+    auto [nameOffsetData, nameOffsetCount] = find(kNameOffsets, sizeof(std::uint32_t), kAnyCount);
+    auto [nameCharData, nameCharCount] = find(kNameChars, sizeof(char), kAnyCount);
+
+    const auto* csrOffsets = static_cast<const EdgeId*>(offsetData);
+    if (csrOffsets[0] != 0 || csrOffsets[n] != m) fail("CSR offsets");
+    const auto* chainOffsets = static_cast<const std::uint32_t*>(shapeOffsetData);
+    if (edgeShapeCount == 0) {
+        if (shapeOffsetCount != 0 || shapePointCount != 0) fail("shapes without edge shapes");
+    } else if (edgeShapeCount != m || shapeOffsetCount == 0 || chainOffsets[0] != 0 ||
+               chainOffsets[shapeOffsetCount - 1] != shapePointCount) {
+        fail("shape offsets");
+    }
+    const auto* nameStarts = static_cast<const std::uint32_t*>(nameOffsetData);
+    if (edgeNameCount == 0) {
+        if (nameOffsetCount != 0 || nameCharCount != 0) fail("names without edge names");
+    } else if (edgeNameCount != m || nameOffsetCount < 2 || nameStarts[0] != 0 ||
+               nameStarts[nameOffsetCount - 1] != nameCharCount) {
+        fail("name offsets");
+    }
+
+    // Every index into another array is checked even when checksums are not, so a
+    // damaged or hand-built file fails here instead of reading out of bounds later
+    if (!nonDecreasing(csrOffsets, offsetCount)) fail("CSR offsets out of order");
+    if (!allBelow(static_cast<const NodeId*>(targetData), targetCount, n)) fail("edge target out of range");
+    if (!allBelow(static_cast<const NodeId*>(keyOrderData), keyOrderCount, n)) fail("key order out of range");
+    if (edgeShapeCount != 0) {
+        if (!nonDecreasing(chainOffsets, shapeOffsetCount)) fail("shape offsets out of order");
+        const auto* shapes = static_cast<const std::uint32_t*>(edgeShapeData);
+        for (std::uint64_t e = 0; e < edgeShapeCount; ++e) {
+            if (shapes[e] != kNoShape && (shapes[e] & ~kReversedShape) >= shapeOffsetCount - 1) {
+                fail("edge shape out of range");
+            }
+        }
+    }
+    if (edgeNameCount != 0) {
+        if (!nonDecreasing(nameStarts, nameOffsetCount)) fail("name offsets out of order");
+        if (!allBelow(static_cast<const std::uint32_t*>(edgeNameData), edgeNameCount, nameOffsetCount - 1)) {
+            fail("edge name out of range");
+        }
+    }
+
+    lats.view(static_cast<const double*>(latData), latCount);
+    lons.view(static_cast<const double*>(lonData), lonCount);
+    offsets.view(csrOffsets, offsetCount);
+    targets.view(static_cast<const NodeId*>(targetData), targetCount);
+    weights.view(static_cast<const double*>(weightData), weightCount);
+    nodeKeys.view(static_cast<const NodeKey*>(keyData), keyCount);
+    keyOrder.view(static_cast<const NodeId*>(keyOrderData), keyOrderCount);
+    edgeShapes.view(static_cast<const std::uint32_t*>(edgeShapeData), edgeShapeCount);
+    shapeOffsets.view(chainOffsets, shapeOffsetCount);
+    shapePoints.view(static_cast<const Coordinate*>(shapePointData), shapePointCount);
+    attributes.view(static_cast<const EdgeAttributes*>(attributeData), attributeCount);
+    edgeNames.view(static_cast<const std::uint32_t*>(edgeNameData), edgeNameCount);
+    nameOffsets.view(nameStarts, nameOffsetCount);
+    nameChars.view(static_cast<const char*>(nameCharData), nameCharCount);
+    mapping = std::move(region);
+    lastLoad = {};
+    buildIndexes();
+}
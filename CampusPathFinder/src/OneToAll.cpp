@@ -0,0 +1,165 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include "OneToAll.h"
+#include "json.hpp"
+using json = nlohmann::json;
+
+namespace {
+constexpr double kInfinity = std::numeric_limits<double>::infinity();
+}
+
+OneToAll::OneToAll(std::shared_ptr<const Graph> graph)
+    : graph(std::move(graph)) {
+    if (!this->graph) {
+        throw std::invalid_argument("OneToAll: graph must not be null");
+    }
+}
+
+std::vector<OneToAll::NodeId> OneToAll::Tree::pathTo(NodeId v) const{
+    std::vector<NodeId> path;
+    if (!reaches(v)) return path;
+    for (NodeId at = v; ; at = parent[at]) {
+        path.push_back(at);
+        if (at == source) break;
+    }
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+// Runs to exhaustion; the arrays are the result, so they are written directly
+OneToAll::Tree OneToAll::tree(NodeId source) const{
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    Tree result;
+    result.source = source;
+    result.distance.assign(graph->nodeCount(), kInfinity);
+    result.parent.assign(graph->nodeCount(), Graph::kInvalidNode);
+    if (source >= graph->nodeCount()) return result;
+
+    std::vector<bool> settled(graph->nodeCount(), false);
+    MinQueue pq;
+    result.distance[source] = 0.0;
+    pq.push(PQItem{0, source});
+
+    while(!pq.empty()){
+        auto [removed_dist, removed] = pq.top();
+        pq.pop();
+
+        if (settled[removed]) continue;
+        settled[removed] = true;
+        result.settledNodes++;
+
+        for(Graph::Neighbor edge : graph->neighbors(removed, Graph::Profile::Walking)){
+            NodeId next = edge.to;
+            double newDist = removed_dist + edge.weight;
+            if(newDist < result.distance[next]){
+                result.distance[next] = newDist;
+                result.parent[next] = removed;
+                pq.push(PQItem{newDist, next});
+            }
+        }
+    }
+
+    result.elapsedMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - startTime).count();
+    return result;
+}
+
+// Stops at the first pop beyond the radius; only touched nodes are ever written
+OneToAll::Isochrone OneToAll::isochrone(NodeId source, double radiusMeters) const{
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    Isochrone result;
+    result.source = source;
+    result.radiusMeters = radiusMeters;
+    if (source >= graph->nodeCount() || radiusMeters < 0.0) return result;
+
+    auto scratch = scratchPool.acquire();
+    SearchWorkspace& workspace = scratch->workspace;
+    MinQueue& pq = scratch->pq;
+    workspace.prepare(graph->nodeCount());
+    while (!pq.empty()) pq.pop();
+
+    workspace.update(source, 0, Graph::kInvalidNode);
+    pq.push(PQItem{0, source});
+
+    while(!pq.empty()){
+        auto [removed_dist, removed] = pq.top();
+        pq.pop();
+
+        if (removed_dist > radiusMeters) break;
+        if (workspace.isSettled(removed) || removed_dist > workspace.distance(removed)) continue;
+        workspace.settle(removed);
+        result.nodes.push_back(removed);
+        result.distances.push_back(removed_dist);
+
+        for(Graph::Neighbor edge : graph->neighbors(removed, Graph::Profile::Walking)){
+            NodeId next = edge.to;
+            if(workspace.isSettled(next)) continue;
+            double newDist = removed_dist + edge.weight;
+            if(newDist < workspace.distance(next)){
+                workspace.update(next, newDist, removed);
+                pq.push(PQItem{newDist, next});
+            }
+        }
+    }
+
+    result.elapsedMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - startTime).count();
+    return result;
+}
+
+OneToAll::Isochrone OneToAll::walkingIsochrone(NodeId source, double minutes, double metersPerSecond) const{
+    return isochrone(source, minutes * 60.0 * metersPerSecond);
+}
+
+std::string OneToAll::Isochrone::toGeoJson(const Graph& graph) const{
+    std::vector<double> reached(graph.nodeCount(), kInfinity);
+    for (std::size_t i = 0; i < nodes.size(); ++i) reached[nodes[i]] = distances[i];
+
+    // Stretch of edge (from -> ...) between two fractions of its length, following its shape
+    auto line = [&](NodeId from, Graph::EdgeId edge, double begin, double end) {
+        json points = json::array();
+        for (const Graph::Coordinate& c : graph.edgeGeometry(from, edge, begin, end)) {
+            points.push_back(json::array({c.lon, c.lat}));
+        }
+        return points;
+    };
+
+    json lines = json::array();
+    for (NodeId u : nodes) {
+        for (Graph::Neighbor edge : graph.neighbors(u, Graph::Profile::Walking)) {
+            NodeId v = edge.to;
+            if (v == u || std::isinf(edge.weight)) continue; // closed ways are not walkable at all
+            bool bothReached = reached[v] != kInfinity;
+            if (bothReached && v < u) continue; // emitted from v's side
+
+            // Walkable stretch from each end; they may meet in the middle
+            double fromU = std::min(edge.weight, radiusMeters - reached[u]);
+            double fromV = bothReached ? std::min(edge.weight, radiusMeters - reached[v]) : 0.0;
+            if (edge.weight <= 0.0 || fromU + fromV >= edge.weight) {
+                lines.push_back(line(u, edge.edge, 0.0, 1.0));
+                continue;
+            }
+            if (fromU > 0.0) lines.push_back(line(u, edge.edge, 0.0, fromU / edge.weight));
+            if (fromV > 0.0) lines.push_back(line(u, edge.edge, 1.0, 1.0 - fromV / edge.weight));
+        }
+    }
+
+    json feature = {
+        {"type", "Feature"},
+        {"properties", {
+            {"source", source < graph.nodeCount() ? graph.nodeName(source) : std::string()},
+            {"radiusMeters", radiusMeters},
+            {"nodeCount", nodes.size()},
+        }},
+        {"geometry", {
+            {"type", "MultiLineString"},
+            {"coordinates", std::move(lines)},
+        }},
+    };
+    return feature.dump();
+}
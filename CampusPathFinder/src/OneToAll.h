@@ -0,0 +1,66 @@
+#ifndef ONETOALL_H
+#define ONETOALL_H
+
+#include <functional>
+#include <memory>
+#include <queue>
+#include <string>
+#include <vector>
+#include "Graph.h"
+#include "ScratchPool.h"
+#include "SearchWorkspace.h"
+
+// Searches that keep going past any single target: the full shortest-path
+// tree from a source, and isochrones (everything within a walking radius)
+// computed as one search bounded by the radius.
+class OneToAll {
+    public:
+        using NodeId = Graph::NodeId;
+
+        static constexpr double kWalkingSpeed = 1.4; // meters per second, about 5 km/h
+
+        // Dense over node IDs: distance is infinity and parent kInvalidNode for unreached nodes
+        struct Tree {
+            NodeId source = Graph::kInvalidNode;
+            std::vector<double> distance;
+            std::vector<NodeId> parent;
+            std::size_t settledNodes = 0;
+            double elapsedMs = 0.0;
+
+            bool reaches(NodeId v) const { return v < parent.size() && (v == source || parent[v] != Graph::kInvalidNode); }
+            std::vector<NodeId> pathTo(NodeId v) const; // source..v, empty if unreached
+        };
+
+        struct Isochrone {
+            NodeId source = Graph::kInvalidNode;
+            double radiusMeters = 0.0;
+            std::vector<NodeId> nodes;      // in order of distance
+            std::vector<double> distances;  // parallel to nodes
+            double elapsedMs = 0.0;
+
+            // Feature with a MultiLineString of every reachable edge stretch:
+            // whole edges, or the part of an edge walkable before the radius runs out
+            std::string toGeoJson(const Graph& graph) const;
+        };
+
+        explicit OneToAll(std::shared_ptr<const Graph> graph);
+
+        Tree tree(NodeId source) const;
+        Isochrone isochrone(NodeId source, double radiusMeters) const;
+        Isochrone walkingIsochrone(NodeId source, double minutes, double metersPerSecond = kWalkingSpeed) const;
+
+        const std::shared_ptr<const Graph>& sharedGraph() const { return graph; }
+
+    private:
+        using PQItem = std::pair<double, NodeId>;
+        using MinQueue = std::priority_queue<PQItem, std::vector<PQItem>, std::greater<PQItem>>;
+        struct Scratch {
+            SearchWorkspace workspace;
+            MinQueue pq;
+        };
+
+        std::shared_ptr<const Graph> graph;
+        ScratchPool<Scratch> scratchPool;
+};
+
+#endif
@@ -0,0 +1,205 @@
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include "PriorityQueues.h"
+
+// ---- BinaryHeapQueue ----
+
+void BinaryHeapQueue::push(const QueueItem& item){
+    heap.push_back(item);
+    std::push_heap(heap.begin(), heap.end(), std::greater<QueueItem>());
+    stats_.pushes++;
+}
+
+void BinaryHeapQueue::pop(){
+    std::pop_heap(heap.begin(), heap.end(), std::greater<QueueItem>());
+    heap.pop_back();
+    stats_.pops++;
+}
+
+// ---- QuaternaryHeapQueue ----
+
+void QuaternaryHeapQueue::reset(std::size_t nodeCount){
+    for (const QueueItem& item : heap) position[item.second] = kAbsent;
+    heap.clear();
+    if (position.size() < nodeCount) position.resize(nodeCount, kAbsent);
+}
+
+void QuaternaryHeapQueue::push(const QueueItem& item){
+    std::uint32_t slot = position[item.second];
+    if (slot == kAbsent) {
+        heap.push_back(item);
+        position[item.second] = static_cast<std::uint32_t>(heap.size() - 1);
+        siftUp(heap.size() - 1);
+        stats_.pushes++;
+    } else if (item.first < heap[slot].first) {
+        heap[slot].first = item.first;
+        siftUp(slot);
+        stats_.decreaseKeys++;
+    }
+}
+
+void QuaternaryHeapQueue::pop(){
+    position[heap.front().second] = kAbsent;
+    QueueItem lastItem = heap.back();
+    heap.pop_back();
+    if (!heap.empty()) {
+        place(0, lastItem);
+        siftDown(0);
+    }
+    stats_.pops++;
+}
+
+void QuaternaryHeapQueue::siftUp(std::size_t i){
+    QueueItem item = heap[i];
+    while (i > 0) {
+        std::size_t parent = (i - 1) / 4;
+        if (!(item < heap[parent])) break;
+        place(i, heap[parent]);
+        i = parent;
+    }
+    place(i, item);
+}
+
+void QuaternaryHeapQueue::siftDown(std::size_t i){
+    QueueItem item = heap[i];
+    const std::size_t n = heap.size();
+    while (true) {
+        std::size_t first = 4 * i + 1;
+        if (first >= n) break;
+        std::size_t best = first;
+        std::size_t end = std::min(first + 4, n);
+        for (std::size_t c = first + 1; c < end; ++c) {
+            if (heap[c] < heap[best]) best = c;
+        }
+        if (!(heap[best] < item)) break;
+        place(i, heap[best]);
+        i = best;
+    }
+    place(i, item);
+}
+
+// ---- RadixHeapQueue ----
+
+void RadixHeapQueue::reset(std::size_t){
+    for (auto& bucket : buckets) bucket.clear();
+    last = 0;
+    count = 0;
+}
+
+void RadixHeapQueue::push(const QueueItem& item){
+    std::uint64_t key = static_cast<std::uint64_t>(std::floor(item.first * kScale));
+    key = std::max(key, last);
+    buckets[bucketOf(key)].push_back({key, item});
+    count++;
+    stats_.pushes++;
+}
+
+// Moves the smallest bucket's entries down once bucket 0 runs dry; each entry
+// only ever moves to a lower bucket, so it is redistributed at most 64 times.
+void RadixHeapQueue::refill(){
+    if (!buckets[0].empty()) return;
+    std::size_t i = 1;
+    while (buckets[i].empty()) ++i;
+    std::vector<Entry>& source = buckets[i];
+    last = std::min_element(source.begin(), source.end(),
+                            [](const Entry& a, const Entry& b) { return a.key < b.key; })->key;
+    for (const Entry& entry : source) buckets[bucketOf(entry.key)].push_back(entry);
+    source.clear();
+}
+
+const QueueItem& RadixHeapQueue::top(){
+    refill();
+    // Entries within bucket 0 share an integer key; hand out the smallest exact one
+    auto& bucket = buckets[0];
+    auto best = std::min_element(bucket.begin(), bucket.end(),
+                                 [](const Entry& a, const Entry& b) { return a.item < b.item; });
+    std::swap(*best, bucket.back());
+    return bucket.back().item;
+}
+
+void RadixHeapQueue::pop(){
+    top();
+    buckets[0].pop_back();
+    count--;
+    stats_.pops++;
+}
+
+// ---- PairingHeapQueue ----
+
+void PairingHeapQueue::reset(std::size_t nodeCount){
+    if (nodes.size() < nodeCount) nodes.resize(nodeCount, Node{0.0, Graph::kInvalidNode, Graph::kInvalidNode,
+                                                               Graph::kInvalidNode, 0});
+    if (++generation == 0) { // wrapped: clear the stamps once every 2^32 queries
+        for (Node& node : nodes) node.generation = 0;
+        generation = 1;
+    }
+    root = Graph::kInvalidNode;
+    count = 0;
+}
+
+PairingHeapQueue::NodeId PairingHeapQueue::meld(NodeId a, NodeId b){
+    if (a == Graph::kInvalidNode) return b;
+    if (b == Graph::kInvalidNode) return a;
+    if (nodes[b].key < nodes[a].key) std::swap(a, b);
+    // b becomes a's leftmost child
+    nodes[b].prev = a;
+    nodes[b].sibling = nodes[a].child;
+    if (nodes[a].child != Graph::kInvalidNode) nodes[nodes[a].child].prev = b;
+    nodes[a].child = b;
+    return a;
+}
+
+void PairingHeapQueue::push(const QueueItem& item){
+    NodeId v = item.second;
+    Node& node = nodes[v];
+    if (node.generation != generation) {
+        node = Node{item.first, Graph::kInvalidNode, Graph::kInvalidNode, Graph::kInvalidNode, generation};
+        root = meld(root, v);
+        count++;
+        stats_.pushes++;
+        return;
+    }
+    if (!(item.first < node.key)) return;
+
+    node.key = item.first;
+    stats_.decreaseKeys++;
+    if (v == root) return;
+
+    // Cut v's subtree out of its sibling list and meld it back at the root
+    NodeId prev = node.prev;
+    if (nodes[prev].child == v) {
+        nodes[prev].child = node.sibling;
+    } else {
+        nodes[prev].sibling = node.sibling;
+    }
+    if (node.sibling != Graph::kInvalidNode) nodes[node.sibling].prev = prev;
+    node.sibling = Graph::kInvalidNode;
+    node.prev = Graph::kInvalidNode;
+    root = meld(root, v);
+}
+
+void PairingHeapQueue::pop(){
+    NodeId old = root;
+    nodes[old].generation = 0;
+
+    // Two-pass pairing: meld children left to right in pairs, then fold right to left
+    scratch.clear();
+    for (NodeId c = nodes[old].child; c != Graph::kInvalidNode;) {
+        NodeId next = nodes[c].sibling;
+        nodes[c].sibling = Graph::kInvalidNode;
+        nodes[c].prev = Graph::kInvalidNode;
+        scratch.push_back(c);
+        c = next;
+    }
+    std::size_t pairs = 0;
+    for (std::size_t i = 0; i < scratch.size(); i += 2) {
+        scratch[pairs++] = i + 1 < scratch.size() ? meld(scratch[i], scratch[i + 1]) : scratch[i];
+    }
+    NodeId merged = Graph::kInvalidNode;
+    for (std::size_t i = pairs; i-- > 0;) merged = meld(scratch[i], merged);
+
+    root = merged;
+    count--;
+    stats_.pops++;
+}
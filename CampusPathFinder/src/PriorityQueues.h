@@ -0,0 +1,164 @@
+#ifndef PRIORITYQUEUES_H
+#define PRIORITYQUEUES_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "Graph.h"
+
+// Min-priority queue policies for the search engines, keyed by node ID.
+// All share one interface so an engine can take any of them as a template
+// parameter:
+//   reset(nodeCount)   empty the queue before a query (keeps capacity and stats)
+//   push({key, node})  insert, or lower the key if the policy supports decrease-key
+//   top() / pop()      smallest key
+//   countStale()       the engine discarded an outdated entry it popped
+// Policies without decrease-key (kDecreaseKey == false) leave outdated entries
+// behind, which the engine skips and reports through countStale().
+
+using QueueItem = std::pair<double, Graph::NodeId>;
+
+struct QueueStats {
+    std::size_t pushes = 0;        // new entries
+    std::size_t decreaseKeys = 0;  // keys lowered in place
+    std::size_t pops = 0;
+    std::size_t stalePops = 0;     // popped entries the engine had already superseded
+
+    QueueStats& operator+=(const QueueStats& other) {
+        pushes += other.pushes;
+        decreaseKeys += other.decreaseKeys;
+        pops += other.pops;
+        stalePops += other.stalePops;
+        return *this;
+    }
+};
+
+// Lazy binary heap (std::push_heap): a cheaper key is pushed as a new entry.
+class BinaryHeapQueue {
+    public:
+        static constexpr const char* kName = "binary heap (lazy)";
+        static constexpr bool kDecreaseKey = false;
+
+        void reset(std::size_t) { heap.clear(); }
+        bool empty() const { return heap.empty(); }
+        std::size_t size() const { return heap.size(); }
+        const QueueItem& top() const { return heap.front(); }
+        void push(const QueueItem& item);
+        void pop();
+        void countStale() { stats_.stalePops++; }
+        const QueueStats& stats() const { return stats_; }
+
+    private:
+        std::vector<QueueItem> heap;
+        QueueStats stats_;
+};
+
+// Indexed 4-ary heap: each node appears at most once and push() on a queued
+// node is a decrease-key. The shallower tree halves sift-up depth and keeps
+// the four children of a slot on one cache line.
+class QuaternaryHeapQueue {
+    public:
+        static constexpr const char* kName = "4-ary heap (decrease-key)";
+        static constexpr bool kDecreaseKey = true;
+
+        void reset(std::size_t nodeCount);
+        bool empty() const { return heap.empty(); }
+        std::size_t size() const { return heap.size(); }
+        const QueueItem& top() const { return heap.front(); }
+        void push(const QueueItem& item);
+        void pop();
+        void countStale() { stats_.stalePops++; }
+        const QueueStats& stats() const { return stats_; }
+
+    private:
+        static constexpr std::uint32_t kAbsent = 0xFFFFFFFFu;
+
+        void siftUp(std::size_t i);
+        void siftDown(std::size_t i);
+        void place(std::size_t i, const QueueItem& item) {
+            heap[i] = item;
+            position[item.second] = static_cast<std::uint32_t>(i);
+        }
+
+        std::vector<QueueItem> heap;
+        std::vector<std::uint32_t> position; // slot of each queued node, kAbsent otherwise
+        QueueStats stats_;
+};
+
+// Radix heap over integer keys (kScale units per meter). Requires monotone
+// use: nothing may be pushed below the last popped key, which holds for
+// Dijkstra and for A* with a consistent heuristic; keys that dip below it by
+// rounding are clamped. Nodes are at least ~1 cm apart, so ties inside one
+// unit never reorder a shortest path. Lazy, like the binary heap.
+class RadixHeapQueue {
+    public:
+        static constexpr const char* kName = "radix heap (lazy)";
+        static constexpr bool kDecreaseKey = false;
+        static constexpr double kScale = 1000.0;
+
+        void reset(std::size_t);
+        bool empty() const { return count == 0; }
+        std::size_t size() const { return count; }
+        const QueueItem& top();
+        void push(const QueueItem& item);
+        void pop();
+        void countStale() { stats_.stalePops++; }
+        const QueueStats& stats() const { return stats_; }
+
+    private:
+        struct Entry {
+            std::uint64_t key;
+            QueueItem item;
+        };
+
+        std::size_t bucketOf(std::uint64_t key) const {
+            return key == last ? 0 : 64 - static_cast<std::size_t>(__builtin_clzll(key ^ last));
+        }
+        void refill();
+
+        std::array<std::vector<Entry>, 65> buckets;
+        std::uint64_t last = 0;
+        std::size_t count = 0;
+        QueueStats stats_;
+};
+
+// Pairing heap with one preallocated tree node per graph node; decrease-key
+// cuts the subtree and melds it back at the root in O(1).
+class PairingHeapQueue {
+    public:
+        static constexpr const char* kName = "pairing heap (decrease-key)";
+        static constexpr bool kDecreaseKey = true;
+
+        void reset(std::size_t nodeCount);
+        bool empty() const { return root == Graph::kInvalidNode; }
+        std::size_t size() const { return count; }
+        QueueItem top() const { return {nodes[root].key, root}; }
+        void push(const QueueItem& item);
+        void pop();
+        void countStale() { stats_.stalePops++; }
+        const QueueStats& stats() const { return stats_; }
+
+    private:
+        using NodeId = Graph::NodeId;
+
+        struct Node {
+            double key;
+            NodeId child;
+            NodeId sibling;
+            NodeId prev;   // parent if leftmost child, else left sibling
+            std::uint32_t generation; // queued in this generation
+        };
+
+        NodeId meld(NodeId a, NodeId b);
+
+        std::vector<Node> nodes;
+        std::vector<NodeId> scratch;
+        NodeId root = Graph::kInvalidNode;
+        std::uint32_t generation = 0;
+        std::size_t count = 0;
+        QueueStats stats_;
+};
+
+#endif
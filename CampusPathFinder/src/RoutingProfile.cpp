@@ -0,0 +1,90 @@
+#include <limits>
+#include "RoutingProfile.h"
+
+namespace {
+
+using Highway = EdgeAttributes::Highway;
+using Surface = EdgeAttributes::Surface;
+using Answer = EdgeAttributes::Answer;
+using Bicycle = EdgeAttributes::Bicycle;
+using Grade = EdgeAttributes::Grade;
+
+constexpr double kClosed = std::numeric_limits<double>::infinity();
+
+bool rough(EdgeAttributes a) { return a.surface() == Surface::Gravel || a.surface() == Surface::Unpaved; }
+
+// Scaled by steepness; past 8% (the ADA ramp limit) a wheelchair cannot go
+double slope(EdgeAttributes a) {
+    if (a.incline() == EdgeAttributes::Incline::None) return 1.0;
+    switch (a.grade()) {
+        case Grade::Gentle: return 1.2;
+        case Grade::Moderate: return 2.0;
+        case Grade::Steep: return 4.0;
+        case Grade::VerySteep: return kClosed;
+        case Grade::Unknown: break;
+    }
+    return 3.0; // tagged sloped, e.g. incline=up, with no grade given
+}
+
+double wheelchair(EdgeAttributes a) {
+    if (a.highway() == Highway::Steps || a.wheelchair() == Answer::No) return kClosed;
+    double f = slope(a);
+    if (a.wheelchair() == Answer::Limited) f *= 2.0;
+    if (a.wheelchair() == Answer::Unknown) f *= 1.1; // ways surveyed as accessible win ties
+    if (rough(a)) f *= 3.0;
+    if (a.surface() == Surface::PavingStones || a.surface() == Surface::Compacted) f *= 1.5;
+    return f;
+}
+
+double bicycle(EdgeAttributes a) {
+    if (a.highway() == Highway::Steps || a.bicycle() == Bicycle::No) return kClosed;
+    double f = 1.0;
+    if (a.bicycle() == Bicycle::Dismount) f *= 3.0; // pushing the bike at walking pace
+    if (a.bicycle() == Bicycle::Unknown && a.highway() != Highway::Cycleway) {
+        f *= a.highway() == Highway::Footway || a.highway() == Highway::Pedestrian ? 2.0 : 1.5;
+    }
+    if (a.segregated() == Answer::No) f *= 1.2; // weaving between pedestrians
+    if (rough(a)) f *= 1.5;
+    return f;
+}
+
+double night(EdgeAttributes a) {
+    if (a.lit() == Answer::Yes) return 1.0;
+    return a.lit() == Answer::No ? 3.0 : 1.5;
+}
+
+double rain(EdgeAttributes a) {
+    double f = a.covered() || a.tunnel() ? 1.0 : 1.5;
+    if (rough(a)) f *= 1.5; // mud
+    return f;
+}
+
+} // namespace
+
+namespace RoutingProfile {
+
+const char* name(Profile profile) {
+    switch (profile) {
+        case Profile::Walking: return "walking";
+        case Profile::Wheelchair: return "wheelchair";
+        case Profile::Bicycle: return "bicycle";
+        case Profile::Night: return "night";
+        case Profile::Rain: return "rain";
+    }
+    return "unknown";
+}
+
+double factor(Profile profile, EdgeAttributes attributes) {
+    const auto access = attributes.access();
+    if (access == EdgeAttributes::Access::Private || access == EdgeAttributes::Access::No) return kClosed;
+    switch (profile) {
+        case Profile::Walking: return 1.0;
+        case Profile::Wheelchair: return wheelchair(attributes);
+        case Profile::Bicycle: return bicycle(attributes);
+        case Profile::Night: return night(attributes);
+        case Profile::Rain: return rain(attributes);
+    }
+    return 1.0;
+}
+
+} // namespace RoutingProfile
@@ -0,0 +1,34 @@
+#ifndef ROUTINGPROFILE_H
+#define ROUTINGPROFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include "EdgeAttributes.h"
+
+// Who is travelling. A profile prices an edge as its length times a factor
+// read from the way's tags: at least 1, or infinity where the profile may not
+// go at all. No edge gets cheaper than its length, so the haversine and
+// landmark bounds built on plain meters stay admissible (and consistent) for
+// every profile. Factors ignore the direction of travel (incline=up and
+// incline=down cost alike), because bidirectional searches and contraction
+// hierarchies walk edges backwards at their forward cost. Ways tagged
+// access=private or access=no are closed to every profile, walking included.
+namespace RoutingProfile {
+
+enum class Profile : std::uint8_t {
+    Walking,    // plain length, on any way the public may use
+    Wheelchair, // no steps or grades over 8%, avoids slopes by steepness and rough surfaces
+    Bicycle,    // honours bicycle=no / dismount, prefers segregated and designated ways
+    Night,      // prefers lit=yes, penalizes ways tagged unlit
+    Rain,       // prefers covered ways and building passages
+};
+constexpr std::size_t kCount = 5;
+
+const char* name(Profile profile);
+
+// Multiplier on an edge's length: >= 1, or infinity when the edge is closed to the profile
+double factor(Profile profile, EdgeAttributes attributes);
+
+} // namespace RoutingProfile
+
+#endif
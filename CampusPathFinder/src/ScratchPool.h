@@ -0,0 +1,72 @@
+#ifndef SCRATCHPOOL_H
+#define SCRATCHPOOL_H
+
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// Hands out reusable scratch objects to concurrent callers. acquire() takes
+// an idle object (or creates one when all are busy) and the returned Lease puts
+// it back when it goes out of scope, so a pool grows to the peak number of
+// concurrent queries and then stops allocating. The mutex is held only to move
+// a pointer in or out of the idle list.
+template <typename T>
+class ScratchPool {
+    public:
+        class Lease {
+            public:
+                Lease(const ScratchPool& pool, std::unique_ptr<T> item)
+                    : pool(&pool), item(std::move(item)) {}
+                Lease(Lease&& other) noexcept = default;
+                Lease(const Lease&) = delete;
+                Lease& operator=(const Lease&) = delete;
+                Lease& operator=(Lease&&) = delete;
+                ~Lease() {
+                    if (item) pool->release(std::move(item));
+                }
+
+                T& operator*() const { return *item; }
+                T* operator->() const { return item.get(); }
+
+            private:
+                const ScratchPool* pool;
+                std::unique_ptr<T> item;
+        };
+
+        ScratchPool() = default;
+        // Scratch state is never shared: a copied engine starts with an empty pool
+        ScratchPool(const ScratchPool&) : ScratchPool() {}
+        ScratchPool& operator=(const ScratchPool&) { return *this; }
+
+        Lease acquire() const {
+            std::unique_ptr<T> item;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!idle.empty()) {
+                    item = std::move(idle.back());
+                    idle.pop_back();
+                }
+            }
+            if (!item) item = std::make_unique<T>();
+            return Lease(*this, std::move(item));
+        }
+
+        // Visits the objects not currently leased out
+        template <typename F>
+        void forEachIdle(F&& visit) const {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (const auto& item : idle) visit(static_cast<const T&>(*item));
+        }
+
+    private:
+        void release(std::unique_ptr<T> item) const {
+            std::lock_guard<std::mutex> lock(mutex);
+            idle.push_back(std::move(item));
+        }
+
+        mutable std::mutex mutex;
+        mutable std::vector<std::unique_ptr<T>> idle;
+};
+
+#endif
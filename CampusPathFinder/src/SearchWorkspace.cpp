@@ -0,0 +1,22 @@
+#include <algorithm>
+#include "SearchWorkspace.h"
+
+void SearchWorkspace::prepare(std::size_t nodeCount){
+    if (seen.size() < nodeCount) {
+        seen.resize(nodeCount, 0);
+        done.resize(nodeCount, 0);
+        dist.resize(nodeCount);
+        prev.resize(nodeCount);
+    }
+
+    // Generation 0 is never live, so a wrapped counter needs one real clear
+    if (++generation == 0) {
+        std::fill(seen.begin(), seen.end(), 0);
+        std::fill(done.begin(), done.end(), 0);
+        generation = 1;
+    }
+
+    stats_.queries++;
+    stats_.lastTouched = 0;
+    stats_.lastSettled = 0;
+}
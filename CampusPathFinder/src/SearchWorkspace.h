@@ -0,0 +1,62 @@
+#ifndef SEARCHWORKSPACE_H
+#define SEARCHWORKSPACE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+#include <vector>
+#include "Graph.h"
+
+// Reusable per-query scratch state (dist / prev / settled) stored in flat arrays.
+// Every slot carries the generation it was last written in, so starting a new
+// query is a counter increment and only touched entries are ever written.
+class SearchWorkspace {
+    public:
+        using NodeId = Graph::NodeId;
+
+        struct Stats {
+            std::size_t queries = 0;
+            std::size_t lastTouched = 0;   // nodes given a tentative distance by the last query
+            std::size_t lastSettled = 0;   // nodes settled by the last query
+            std::size_t totalTouched = 0;
+            std::size_t totalSettled = 0;
+        };
+
+        // Starts a new query over a graph with nodeCount nodes (grows the arrays if needed)
+        void prepare(std::size_t nodeCount);
+
+        double distance(NodeId v) const {
+            return seen[v] == generation ? dist[v] : std::numeric_limits<double>::infinity();
+        }
+        NodeId parent(NodeId v) const {
+            return seen[v] == generation ? prev[v] : Graph::kInvalidNode;
+        }
+        bool isSettled(NodeId v) const { return done[v] == generation; }
+
+        void update(NodeId v, double d, NodeId parentNode) {
+            if (seen[v] != generation) {
+                seen[v] = generation;
+                stats_.lastTouched++;
+                stats_.totalTouched++;
+            }
+            dist[v] = d;
+            prev[v] = parentNode;
+        }
+        void settle(NodeId v) {
+            done[v] = generation;
+            stats_.lastSettled++;
+            stats_.totalSettled++;
+        }
+
+        const Stats& stats() const { return stats_; }
+
+    private:
+        std::vector<std::uint32_t> seen;   // generation in which dist/prev were last written
+        std::vector<std::uint32_t> done;   // generation in which the node was settled
+        std::vector<double> dist;
+        std::vector<NodeId> prev;
+        std::uint32_t generation = 0;
+        Stats stats_;
+};
+
+#endif
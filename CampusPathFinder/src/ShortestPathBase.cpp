@@ -4,38 +4,286 @@
 #include <queue>
 #include <vector>
 #include <functional>
-#include <unordered_map>
-#include <utility>
+#include <algorithm>
+#include <cmath>
 #include <limits>
+#include <stdexcept>
+#include <utility>
 #include "ShortestPathBase.h"
+#include "ThreadPool.h"
 
-void ShortestPathBase::Init(){ //Intializes all helper containers to default friendly values
-    prev.clear();
-    visited.clear();
-    dist.clear();
-    
-    for (auto& kv : graph.nodeData) {
-        prev[kv.first] = "";
-        visited[kv.first] = false;
-        dist[kv.first] = std::numeric_limits<double>::infinity();
+ShortestPathBase::ShortestPathBase(std::shared_ptr<const Graph> graph)
+    : graph(std::move(graph)) {
+    if (!this->graph) {
+        throw std::invalid_argument("ShortestPathBase: graph must not be null");
+    }
+}
+
+ShortestPathBase::PathResult ShortestPathBase::computePath(const std::string& start, const std::string& end,
+                                                         Profile profile) const{
+    return computePath(graph->nodeId(start), graph->nodeId(end), profile);
+}
+
+ShortestPathBase::PathResult ShortestPathBase::computePath(const Graph::Coordinate& start, const Graph::Coordinate& end,
+                                                         Profile profile) const{
+    // Snap onto edges the profile may use, or the search could only start from a closed way's ends
+    return computePath(graph->nearestEdgePoint(start.lat, start.lon, profile),
+                       graph->nearestEdgePoint(end.lat, end.lon, profile), profile);
+}
+
+namespace {
+
+struct EdgeEnd {
+    Graph::NodeId node;
+    double partial; // weight between the point and this end of its edge
+};
+
+// The ends of both edges as virtual source / target nodes, and the walk straight
+// along the edge when both points lie on it
+struct EdgeEnds {
+    EdgeEnd sources[2];
+    EdgeEnd exits[2];
+    double endOnStartEdge = -1.0; // end's fraction measured along start's edge; -1 if on another edge
+    double alongEdge = std::numeric_limits<double>::infinity();
+};
+
+EdgeEnds edgeEnds(const Graph& graph, const Graph::EdgePoint& start, const Graph::EdgePoint& end,
+                  Graph::Profile profile) {
+    // A point exactly at the end of an edge the profile closes still leaves through that end
+    auto part = [](double fraction, double weight) { return fraction == 0.0 ? 0.0 : fraction * weight; };
+    const double startWeight = graph.edgeWeight(start.edge, profile);
+    const double endWeight = graph.edgeWeight(end.edge, profile);
+    EdgeEnds ends{{{start.from, part(start.fraction, startWeight)},
+                   {graph.edgeTarget(start.edge), part(1.0 - start.fraction, startWeight)}},
+                  {{end.from, part(end.fraction, endWeight)},
+                   {graph.edgeTarget(end.edge), part(1.0 - end.fraction, endWeight)}}};
+
+    // Compared by edge, not by end nodes: contracted chains can run parallel to another edge
+    if (end.edge == start.edge) ends.endOnStartEdge = end.fraction;
+    else if (end.edge == graph.reverseEdge(start.from, start.edge)) ends.endOnStartEdge = 1.0 - end.fraction;
+    if (ends.endOnStartEdge >= 0.0) ends.alongEdge = part(std::abs(start.fraction - ends.endOnStartEdge), startWeight);
+    return ends;
+}
+
+} // namespace
+
+// Plain Dijkstra over the unchanged graph: the seeds and the exit partials stand
+// in for the virtual nodes
+ShortestPathBase::PathResult ShortestPathBase::computePath(const Graph::EdgePoint& start, const Graph::EdgePoint& end,
+                                                         Profile profile) const{
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    PathResult result;
+    result.reachable = false;
+    result.weight = 0.0;
+    result.elapsedMs = 0.0;
+
+    if (!graph->isValid(start) || !graph->isValid(end)) {
+        return result;
+    }
+    if (!graph->connected(start.from, end.from)) {
+        return finish(result, startTime); // different components: nothing to search
     }
+
+    const EdgeEnds ends = edgeEnds(*graph, start, end, profile);
+    double best = ends.alongEdge;
+
+    auto scratch = scratchPool.acquire();
+    Init(*scratch);
+    SearchWorkspace& workspace = scratch->workspace;
+    MinQueue& pq = scratch->pq;
+
+    for (const EdgeEnd& seed : ends.sources) {
+        if (seed.partial < workspace.distance(seed.node)) {
+            workspace.update(seed.node, seed.partial, Graph::kInvalidNode);
+            pq.push(PQItem{seed.partial, seed.node});
+        }
+    }
+
+    NodeId exit = Graph::kInvalidNode; // kInvalidNode: best route never leaves the shared edge
+    while(!pq.empty()){
+        auto [removed_dist, removed] = pq.top();
+        pq.pop();
+
+        if (removed_dist >= best) break; // every later exit costs at least this much
+        if (workspace.isSettled(removed) || removed_dist > workspace.distance(removed)) continue;
+        workspace.settle(removed);
+
+        for (const EdgeEnd& candidate : ends.exits) {
+            if (removed == candidate.node && removed_dist + candidate.partial < best) {
+                best = removed_dist + candidate.partial;
+                exit = removed;
+            }
+        }
+
+        for(Graph::Neighbor edge : graph->neighbors(removed, profile)){
+            NodeId next = edge.to;
+            if(workspace.isSettled(next)) continue;
+            double newDist = removed_dist + edge.weight;
+            if(newDist < workspace.distance(next)){
+                workspace.update(next, newDist, removed);
+                pq.push(PQItem{newDist, next});
+            }
+        }
+    }
+
+    result.touchedNodes = workspace.stats().lastTouched;
+    result.settledNodes = workspace.stats().lastSettled;
+
+    if (best != std::numeric_limits<double>::infinity()) {
+        std::vector<NodeId> nodes;
+        for (NodeId at = exit; at != Graph::kInvalidNode; at = workspace.parent(at)) nodes.push_back(at);
+        std::reverse(nodes.begin(), nodes.end());
+        traceEdgePoints(result, start, end, nodes, ends.endOnStartEdge, profile);
+        result.weight = best;
+    }
+
+    result.elapsedMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - startTime).count();
+    return result;
+}
+
+// Up to four node-to-node queries on the engine itself, one per pair of edge
+// ends, so each inherits the engine's speedups and its checks
+ShortestPathBase::PathResult ShortestPathBase::computePathViaEdgeEnds(const Graph::EdgePoint& start,
+                                                                    const Graph::EdgePoint& end,
+                                                                    Profile profile) const{
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    PathResult result;
+    result.reachable = false;
+    result.weight = 0.0;
+    result.elapsedMs = 0.0;
+
+    if (!graph->isValid(start) || !graph->isValid(end)) {
+        return result;
+    }
+    if (!graph->connected(start.from, end.from)) {
+        return finish(result, startTime);
+    }
+
+    const EdgeEnds ends = edgeEnds(*graph, start, end, profile);
+    double best = ends.alongEdge;
+    PathResult via; // best route that leaves the start edge
+    for (const EdgeEnd& source : ends.sources) {
+        for (const EdgeEnd& exit : ends.exits) {
+            if (source.partial + exit.partial >= best) continue;
+            PathResult leg = computePath(source.node, exit.node, profile);
+            result.touchedNodes += leg.touchedNodes;
+            result.settledNodes += leg.settledNodes;
+            if (!leg.reachable || source.partial + leg.weight + exit.partial >= best) continue;
+            best = source.partial + leg.weight + exit.partial;
+            via = std::move(leg);
+        }
+    }
+
+    if (best != std::numeric_limits<double>::infinity()) {
+        std::vector<NodeId> nodes;
+        for (const std::string& name : via.path) nodes.push_back(graph->nodeId(name));
+        traceEdgePoints(result, start, end, nodes, ends.endOnStartEdge, profile);
+        result.weight = best;
+    }
+
+    result.elapsedMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - startTime).count();
+    return result;
+}
+
+// Fills path and geometry; nodes is empty when the route stays on the shared edge
+void ShortestPathBase::traceEdgePoints(PathResult& result, const Graph::EdgePoint& start, const Graph::EdgePoint& end,
+                                       const std::vector<NodeId>& nodes, double endOnStartEdge, Profile profile) const{
+    result.reachable = true;
+    if (nodes.empty()) {
+        result.geometry = graph->edgeGeometry(start.from, start.edge, start.fraction, endOnStartEdge);
+        return;
+    }
+
+    // Partial start edge, whole nodes, partial end edge; shared corners appear once
+    const double leave = nodes.front() == start.from ? 0.0 : 1.0;
+    result.geometry = graph->edgeGeometry(start.from, start.edge, start.fraction, leave);
+    auto middle = graph->pathGeometry(nodes, profile);
+    result.geometry.insert(result.geometry.end(), middle.begin() + 1, middle.end());
+    const double enter = nodes.back() == end.from ? 0.0 : 1.0;
+    auto tail = graph->edgeGeometry(end.from, end.edge, enter, end.fraction);
+    result.geometry.insert(result.geometry.end(), tail.begin() + 1, tail.end());
+
+    for (NodeId v : nodes) result.path.push_back(graph->nodeName(v));
+}
+
+std::vector<ShortestPathBase::PathResult>
+ShortestPathBase::computePaths(std::span<const std::pair<NodeId, NodeId>> queries, ThreadPool* pool,
+                               Profile profile) const{
+    std::vector<PathResult> results(queries.size());
+    ThreadPool& workers = pool ? *pool : ThreadPool::shared();
+    workers.parallelFor(queries.size(), [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            results[i] = computePath(queries[i].first, queries[i].second, profile);
+        }
+    });
+    return results;
+}
+
+ShortestPathBase::PathResult ShortestPathBase::finish(PathResult& result,
+                                                     std::chrono::high_resolution_clock::time_point startTime){
+    result.elapsedMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - startTime).count();
+    return std::move(result);
+}
+
+void ShortestPathBase::Init(Scratch& scratch) const{ //Starts a new generation in the workspace; O(1) unless the graph grew
+    scratch.workspace.prepare(graph->nodeCount());
     
-    while (!pq.empty()) pq.pop();
+    while (!scratch.pq.empty()) scratch.pq.pop();
+
+}
+
+SearchWorkspace::Stats ShortestPathBase::workspaceStats() const{
+    SearchWorkspace::Stats total;
+    scratchPool.forEachIdle([&](const Scratch& scratch) {
+        addStats(total, scratch.workspace, &scratch.backward);
+    });
+    return total;
+}
 
+// A query counts once even when a backward search shared it
+void ShortestPathBase::addStats(SearchWorkspace::Stats& total, const SearchWorkspace& forward,
+                                const SearchWorkspace* backward){
+    total.queries += forward.stats().queries;
+    total.totalTouched += forward.stats().totalTouched;
+    total.totalSettled += forward.stats().totalSettled;
+    if (backward) {
+        total.totalTouched += backward->stats().totalTouched;
+        total.totalSettled += backward->stats().totalSettled;
+    }
 }
 
-void ShortestPathBase::printPath(const std::string& start, const std::string& end) const{ //helper to print best path
-    std::string traversal = end;
-    std::stack<std::string> path;
+void ShortestPathBase::printPath(NodeId start, NodeId end, const SearchWorkspace& tree) const{ //helper to print best path
+    NodeId traversal = end;
+    std::stack<NodeId> path;
     
     while(traversal != start){
         path.push(traversal);
-        traversal = prev.at(traversal);
+        traversal = tree.parent(traversal);
     }
     path.push(start);
     
     while(!path.empty()){
-        std::cout << path.top() << " ";
+        std::cout << graph->nodeName(path.top()) << " ";
         path.pop();
     }
 }
+
+std::vector<std::string> ShortestPathBase::buildPath(NodeId start, NodeId end, const SearchWorkspace& tree) const{ //walks prev back from end, translating IDs to node names
+    std::vector<std::string> forwardPath;
+
+    NodeId traversal = end;
+
+    while(traversal != start){
+        forwardPath.push_back(graph->nodeName(traversal));
+        traversal = tree.parent(traversal);
+    }
+    forwardPath.push_back(graph->nodeName(start));
+    
+    std::reverse(forwardPath.begin(),forwardPath.end());
+    return forwardPath;
+}
@@ -7,34 +7,96 @@
 #include <queue>
 #include <vector>
 #include <functional>
-#include <unordered_map>
 #include <utility>
+#include <memory>
 #include "Graph.h"
+#include <span>
+#include "ScratchPool.h"
+#include "SearchWorkspace.h"
+
+class ThreadPool;
 
 class ShortestPathBase {
     public:
+        using NodeId = Graph::NodeId;
+        using Profile = Graph::Profile;
+
         struct PathResult{
             bool reachable;
             std::vector<std::string> path;
             double weight;
             double elapsedMs;   
+            std::size_t touchedNodes = 0;  // nodes whose distance was written by this query
+            std::size_t settledNodes = 0;  // nodes popped and finalized by this query
+            std::vector<Graph::Coordinate> geometry; // edge-point queries: exact polyline from start to end point
         };
-        virtual PathResult computePath(const std::string& start, const std::string& end) = 0;
+        virtual ~ShortestPathBase() = default;
+        // Safe to call from many threads on one engine: all search state lives
+        // in scratch objects leased per call, the engine itself is never written.
+        // Unknown names / out-of-range IDs give an unreachable result. Each call
+        // may pick its own routing profile (walking by default); weight is then
+        // the profile's cost, which is meters only for walking.
+        PathResult computePath(const std::string& start, const std::string& end,
+                               Profile profile = Profile::Walking) const;
+        PathResult computePath(NodeId source, NodeId target) const { return computePath(source, target, Profile::Walking); }
+        virtual PathResult computePath(NodeId source, NodeId target, Profile profile) const = 0;
+        // Routes between points part-way along edges. The ends of each edge act as
+        // virtual source / target nodes: by default one plain Dijkstra is seeded from
+        // both ends of the start edge with their partial weights and finishes through
+        // whichever end of the target edge is cheaper. Engines whose speedup needs
+        // their own search (ContractionHierarchy, AltAstar) answer through
+        // computePathViaEdgeEnds instead. The graph itself is never modified. path
+        // lists the whole nodes passed (empty if both points share an edge).
+        virtual PathResult computePath(const Graph::EdgePoint& start, const Graph::EdgePoint& end,
+                                       Profile profile = Profile::Walking) const;
+        // Arbitrary points (e.g. a GPS fix) are snapped onto the nearest edges first
+        PathResult computePath(const Graph::Coordinate& start, const Graph::Coordinate& end,
+                               Profile profile = Profile::Walking) const;
+
+        // Answers every (source, target) pair on the pool (ThreadPool::shared()
+        // by default); results come back in input order. Workers reuse the
+        // engine's pooled scratch, so a batch allocates at most one per worker.
+        std::vector<PathResult> computePaths(std::span<const std::pair<NodeId, NodeId>> queries,
+                                             ThreadPool* pool = nullptr, Profile profile = Profile::Walking) const;
+
+        const std::shared_ptr<const Graph>& sharedGraph() const { return graph; }
+
+        // Totals over the engine's idle workspaces (queries still in flight are not included)
+        virtual SearchWorkspace::Stats workspaceStats() const;
     
     protected:
-        void Init();
-        void printPath(const std::string& start, const std::string& end) const;
-    
-        Graph graph;
-        std::unordered_map<std::string, std::string> prev;
-        std::unordered_map<std::string, bool> visited;
-        std::unordered_map<std::string, double> dist;
-
-        using PQItem = std::pair<double, std::string>;
-        std::priority_queue<
+        using PQItem = std::pair<double, NodeId>;
+        using MinQueue = std::priority_queue<
             PQItem,
             std::vector<PQItem>,
             std::greater<PQItem>
-        > pq;
+        >;
+
+        // Per-query search state; bidirectional engines also use the backward half
+        struct Scratch {
+            SearchWorkspace workspace;
+            MinQueue pq;
+            SearchWorkspace backward;
+            MinQueue backwardPq;
+        };
+
+        explicit ShortestPathBase(std::shared_ptr<const Graph> graph);
+
+        void Init(Scratch& scratch) const;
+        // Edge-point query as up to four of the engine's own node-to-node queries
+        // (each end of the start edge to each end of the target edge)
+        PathResult computePathViaEdgeEnds(const Graph::EdgePoint& start, const Graph::EdgePoint& end,
+                                          Profile profile) const;
+        void traceEdgePoints(PathResult& result, const Graph::EdgePoint& start, const Graph::EdgePoint& end,
+                             const std::vector<NodeId>& nodes, double endOnStartEdge, Profile profile) const;
+        // Stamps elapsedMs on a result that returns early (unreachable, rejected)
+        static PathResult finish(PathResult& result, std::chrono::high_resolution_clock::time_point startTime);
+        void printPath(NodeId start, NodeId end, const SearchWorkspace& tree) const;
+        std::vector<std::string> buildPath(NodeId start, NodeId end, const SearchWorkspace& tree) const;
+        static void addStats(SearchWorkspace::Stats& total, const SearchWorkspace& forward,
+                             const SearchWorkspace* backward = nullptr);
+    
+        std::shared_ptr<const Graph> graph; // immutable, shared between engines
+        ScratchPool<Scratch> scratchPool;
 };
 #endif
@@ -0,0 +1,207 @@
+#include <algorithm>
+#include <cmath>
+#include "Graph.h"
+#include "SpatialIndex.h"
+
+namespace {
+
+constexpr double kMetersPerDegree = Geo::kEarthRadius * M_PI / 180.0;
+constexpr double kNodesPerCell = 2.0;
+
+double squared(double v) { return v * v; }
+
+} // namespace
+
+std::int64_t SpatialIndex::cellX(double x) const{
+    return std::clamp<std::int64_t>(static_cast<std::int64_t>(std::floor(x / cellSize)), 0, cols - 1);
+}
+
+std::int64_t SpatialIndex::cellY(double y) const{
+    return std::clamp<std::int64_t>(static_cast<std::int64_t>(std::floor(y / cellSize)), 0, rows - 1);
+}
+
+// Polyline point i of an indexed edge; the end nodes come from the projected cache
+SpatialIndex::Point SpatialIndex::segmentPoint(const Graph& graph, const IndexedEdge& item, std::size_t i,
+                                               std::size_t count) const{
+    if (i == 0) return projected[item.from];
+    if (i + 1 == count) return projected[graph.edgeTarget(item.edge)];
+    Graph::Coordinate c = graph.edgePoint(item.from, item.edge, i);
+    return project(c.lat, c.lon);
+}
+
+void SpatialIndex::build(const Graph& graph){
+    *this = SpatialIndex();
+    const std::size_t n = graph.nodeCount();
+    if (n == 0) return;
+
+    double minLat = graph.location(0).lat, maxLat = minLat;
+    double minLon = graph.location(0).lon, maxLon = minLon;
+    for (Graph::NodeId v : graph.nodes()) {
+        minLat = std::min(minLat, graph.location(v).lat);
+        maxLat = std::max(maxLat, graph.location(v).lat);
+        minLon = std::min(minLon, graph.location(v).lon);
+        maxLon = std::max(maxLon, graph.location(v).lon);
+    }
+    originLat = minLat;
+    originLon = minLon;
+    metersPerDegreeLat = kMetersPerDegree;
+    metersPerDegreeLon = kMetersPerDegree * std::cos((minLat + maxLat) / 2.0 * M_PI / 180.0);
+
+    // Square cells sized for a couple of nodes each
+    const double width = std::max((maxLon - minLon) * metersPerDegreeLon, 1.0);
+    const double height = std::max((maxLat - minLat) * metersPerDegreeLat, 1.0);
+    cellSize = std::max(std::sqrt(width * height * kNodesPerCell / n), 1.0);
+    cols = static_cast<std::int64_t>(width / cellSize) + 1;
+    rows = static_cast<std::int64_t>(height / cellSize) + 1;
+    const std::size_t cells = static_cast<std::size_t>(cols * rows);
+
+    projected.resize(n);
+    for (Graph::NodeId v : graph.nodes()) projected[v] = project(graph.location(v).lat, graph.location(v).lon);
+    auto cellOf = [&](Point p) { return static_cast<std::size_t>(cellY(p.y) * cols + cellX(p.x)); };
+
+    // Counting sort of nodes into cells
+    nodeOffsets.assign(cells + 1, 0);
+    for (const Point& p : projected) nodeOffsets[cellOf(p) + 1]++;
+    for (std::size_t c = 0; c < cells; ++c) nodeOffsets[c + 1] += nodeOffsets[c];
+    nodeItems.resize(n);
+    std::vector<std::uint32_t> fill(nodeOffsets.begin(), nodeOffsets.end() - 1);
+    for (Graph::NodeId v : graph.nodes()) nodeItems[fill[cellOf(projected[v])]++] = v;
+
+    // Each undirected edge once (from the lower ID), each polyline segment in
+    // every cell its bounding box covers
+    auto forEachEdgeCell = [&](auto&& emit) {
+        for (Graph::NodeId u : graph.nodes()) {
+            for (Graph::Neighbor edge : graph.neighbors(u)) {
+                if (edge.to < u) continue;
+                const std::size_t count = graph.edgePointCount(edge.edge);
+                for (std::uint32_t s = 0; s + 1 < count; ++s) {
+                    const IndexedEdge item{edge.edge, u, s};
+                    const Point a = segmentPoint(graph, item, s, count);
+                    const Point b = segmentPoint(graph, item, s + 1, count);
+                    for (std::int64_t y = cellY(std::min(a.y, b.y)); y <= cellY(std::max(a.y, b.y)); ++y) {
+                        for (std::int64_t x = cellX(std::min(a.x, b.x)); x <= cellX(std::max(a.x, b.x)); ++x) {
+                            emit(static_cast<std::size_t>(y * cols + x), item);
+                        }
+                    }
+                }
+            }
+        }
+    };
+    edgeOffsets.assign(cells + 1, 0);
+    forEachEdgeCell([&](std::size_t cell, IndexedEdge) { edgeOffsets[cell + 1]++; });
+    for (std::size_t c = 0; c < cells; ++c) edgeOffsets[c + 1] += edgeOffsets[c];
+    edgeItems.resize(edgeOffsets[cells]);
+    fill.assign(edgeOffsets.begin(), edgeOffsets.end() - 1);
+    forEachEdgeCell([&](std::size_t cell, IndexedEdge item) { edgeItems[fill[cell]++] = item; });
+}
+
+template <typename Visit>
+void SpatialIndex::searchRings(Point p, const double& best, Visit&& visit) const{
+    // Rings grow around the closest point of the grid. Everything indexed lies in
+    // the grid, and for any x in it |p - x|^2 >= |p - q|^2 + |q - x|^2, since q is
+    // p's projection onto that box
+    const Point q{std::clamp(p.x, 0.0, cols * cellSize), std::clamp(p.y, 0.0, rows * cellSize)};
+    const double outside = squared(p.x - q.x) + squared(p.y - q.y);
+    const std::int64_t cx = cellX(q.x);
+    const std::int64_t cy = cellY(q.y);
+    const std::int64_t maxRing = std::max(cols, rows);
+
+    for (std::int64_t r = 0; r <= maxRing; ++r) {
+        if (r > 0) {
+            // Ring r lies outside the square of rings < r; anything in it is at least this far from q
+            double bound = std::min({q.x - (cx - r + 1) * cellSize, (cx + r) * cellSize - q.x,
+                                     q.y - (cy - r + 1) * cellSize, (cy + r) * cellSize - q.y});
+            if (outside + squared(bound) >= best) return;
+        }
+        for (std::int64_t y = std::max<std::int64_t>(cy - r, 0); y <= std::min(cy + r, rows - 1); ++y) {
+            const bool edgeRow = y == cy - r || y == cy + r;
+            for (std::int64_t x = std::max<std::int64_t>(cx - r, 0); x <= std::min(cx + r, cols - 1); ++x) {
+                if (!edgeRow && x != cx - r && x != cx + r) continue; // interior cells belong to earlier rings
+                visit(static_cast<std::size_t>(y * cols + x));
+            }
+        }
+    }
+}
+
+SpatialIndex::NodeId SpatialIndex::nearestNode(const Graph&, double lat, double lon) const{
+    NodeId bestNode = Graph::kInvalidNode;
+    if (empty()) return bestNode;
+
+    const Point p = project(lat, lon);
+    double best = std::numeric_limits<double>::infinity(); // squared meters
+    searchRings(p, best, [&](std::size_t cell) {
+        for (std::uint32_t i = nodeOffsets[cell]; i < nodeOffsets[cell + 1]; ++i) {
+            NodeId v = nodeItems[i];
+            double d = squared(projected[v].x - p.x) + squared(projected[v].y - p.y);
+            if (d < best || (d == best && v < bestNode)) {
+                best = d;
+                bestNode = v;
+            }
+        }
+    });
+    return bestNode;
+}
+
+SpatialIndex::EdgePoint SpatialIndex::nearestEdgePoint(const Graph& graph, double lat, double lon) const{
+    if (empty()) return {};
+    return nearestEdgePoint(graph, project(lat, lon), nullptr);
+}
+
+SpatialIndex::EdgePoint SpatialIndex::nearestEdgePoint(const Graph& graph, double lat, double lon,
+                                                    RoutingProfile::Profile profile) const{
+    if (empty()) return {};
+    return nearestEdgePoint(graph, project(lat, lon), graph.edgeWeights(profile).data());
+}
+
+SpatialIndex::EdgePoint SpatialIndex::nearestEdgePoint(const Graph& graph, Point p, const double* costs) const{
+    EdgePoint result;
+    double best = std::numeric_limits<double>::infinity(); // squared meters
+    std::uint32_t bestSegment = 0;
+    searchRings(p, best, [&](std::size_t cell) {
+        for (std::uint32_t i = edgeOffsets[cell]; i < edgeOffsets[cell + 1]; ++i) {
+            const IndexedEdge& item = edgeItems[i];
+            if (costs && std::isinf(costs[item.edge])) continue;
+            const std::size_t count = graph.edgePointCount(item.edge);
+            const Point a = segmentPoint(graph, item, item.segment, count);
+            const Point b = segmentPoint(graph, item, item.segment + 1, count);
+            const double dx = b.x - a.x;
+            const double dy = b.y - a.y;
+            const double length2 = dx * dx + dy * dy;
+            double t = length2 > 0.0 ? ((p.x - a.x) * dx + (p.y - a.y) * dy) / length2 : 0.0;
+            t = std::clamp(t, 0.0, 1.0);
+            double d = squared(a.x + t * dx - p.x) + squared(a.y + t * dy - p.y);
+            if (d < best) {
+                best = d;
+                result.edge = item.edge;
+                result.from = item.from;
+                result.fraction = t; // along the segment for now
+                bestSegment = item.segment;
+            }
+        }
+    });
+
+    if (result.edge != kInvalidEdge) {
+        const Graph::Coordinate a = graph.edgePoint(result.from, result.edge, bestSegment);
+        const Graph::Coordinate b = graph.edgePoint(result.from, result.edge, bestSegment + 1);
+        result.lat = a.lat + (b.lat - a.lat) * result.fraction;
+        result.lon = a.lon + (b.lon - a.lon) * result.fraction;
+        result.distance = std::sqrt(best);
+
+        // Convert to a fraction of the whole polyline, measured the way edge weights are
+        const std::size_t count = graph.edgePointCount(result.edge);
+        if (count > 2) {
+            double total = 0.0, before = 0.0;
+            Graph::Coordinate prev = graph.edgePoint(result.from, result.edge, 0);
+            for (std::size_t i = 1; i < count; ++i) {
+                Graph::Coordinate next = graph.edgePoint(result.from, result.edge, i);
+                double length = Geo::haversine(prev.lat, prev.lon, next.lat, next.lon);
+                if (i - 1 < bestSegment) before += length;
+                if (i - 1 == bestSegment) before += length * result.fraction;
+                total += length;
+                prev = next;
+            }
+            result.fraction = total > 0.0 ? std::clamp(before / total, 0.0, 1.0) : 0.0;
+        }
+    }
+    return result;
+}
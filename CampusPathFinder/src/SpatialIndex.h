@@ -0,0 +1,80 @@
+#ifndef SPATIALINDEX_H
+#define SPATIALINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "RoutingProfile.h"
+
+class Graph;
+
+// Uniform grid over the graph's nodes and edges in local equirectangular
+// meters (exact enough at campus scale). A lookup scans rings of cells
+// outward from the query point and stops once the next ring cannot hold
+// anything closer, so a snap touches a handful of cells regardless of graph
+// size. Owns only its own arrays; queries take the graph it was built from.
+class SpatialIndex {
+    public:
+        using NodeId = std::uint32_t;
+        using EdgeId = std::uint32_t;
+        static constexpr EdgeId kInvalidEdge = std::numeric_limits<EdgeId>::max();
+
+        // Closest point on any edge: fraction runs 0..1 along the edge's length (its
+        // polyline when chains were contracted) from its source to its target
+        struct EdgePoint {
+            EdgeId edge = kInvalidEdge;
+            NodeId from = std::numeric_limits<NodeId>::max();
+            double fraction = 0.0;
+            double lat = 0.0;
+            double lon = 0.0;
+            double distance = std::numeric_limits<double>::infinity(); // meters from the query point
+        };
+
+        void build(const Graph& graph);
+        bool empty() const { return nodeItems.empty(); }
+
+        NodeId nearestNode(const Graph& graph, double lat, double lon) const; // kInvalidNode if empty
+        EdgePoint nearestEdgePoint(const Graph& graph, double lat, double lon) const;
+        // Only edges the profile may use (finite cost) are candidates
+        EdgePoint nearestEdgePoint(const Graph& graph, double lat, double lon, RoutingProfile::Profile profile) const;
+
+    private:
+        struct Point {
+            double x;
+            double y;
+        };
+        struct IndexedEdge {
+            EdgeId edge;
+            NodeId from;
+            std::uint32_t segment; // which piece of the edge's polyline
+        };
+
+        Point project(double lat, double lon) const {
+            return {(lon - originLon) * metersPerDegreeLon, (lat - originLat) * metersPerDegreeLat};
+        }
+        EdgePoint nearestEdgePoint(const Graph& graph, Point p, const double* costs) const; // costs null: any edge
+        Point segmentPoint(const Graph& graph, const IndexedEdge& item, std::size_t i, std::size_t count) const;
+        std::int64_t cellX(double x) const;
+        std::int64_t cellY(double y) const;
+
+        // Calls visit(cell) ring by ring until best (updated by visit) is provably final
+        template <typename Visit>
+        void searchRings(Point p, const double& best, Visit&& visit) const;
+
+        double originLat = 0.0;
+        double originLon = 0.0;
+        double metersPerDegreeLat = 0.0;
+        double metersPerDegreeLon = 0.0;
+        double cellSize = 1.0;
+        std::int64_t cols = 0;
+        std::int64_t rows = 0;
+
+        std::vector<Point> projected; // per node
+        std::vector<std::uint32_t> nodeOffsets; // per cell, CSR into nodeItems
+        std::vector<NodeId> nodeItems;
+        std::vector<std::uint32_t> edgeOffsets; // per cell, CSR into edgeItems
+        std::vector<IndexedEdge> edgeItems;
+};
+
+#endif
@@ -0,0 +1,100 @@
+#include <algorithm>
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(std::size_t threads){
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    for (std::size_t i = 0; i < threads; ++i) queues.push_back(std::make_unique<TaskQueue>());
+    for (std::size_t i = 0; i < threads; ++i) workers.emplace_back([this, i] { workerLoop(i); });
+}
+
+ThreadPool::~ThreadPool(){
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) worker.join();
+}
+
+ThreadPool& ThreadPool::shared(){
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::parallelFor(std::size_t count, const RangeFn& body, std::size_t grain){
+    if (count == 0) return;
+    const std::size_t threads = workers.size();
+    if (grain == 0) grain = std::max<std::size_t>(1, count / (threads * 16)); // enough chunks to steal
+    const std::size_t chunks = (count + grain - 1) / grain;
+
+    Batch batch;
+    batch.body = &body;
+    batch.remaining = chunks;
+
+    // Worker w owns a contiguous run of chunks, so without stealing it walks the input in order
+    for (std::size_t w = 0; w < threads; ++w) {
+        std::size_t firstChunk = chunks * w / threads;
+        std::size_t lastChunk = chunks * (w + 1) / threads;
+        if (firstChunk == lastChunk) continue;
+        std::lock_guard<std::mutex> lock(queues[w]->mutex);
+        for (std::size_t c = firstChunk; c < lastChunk; ++c) {
+            queues[w]->tasks.push_back({&batch, c * grain, std::min(count, (c + 1) * grain)});
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        queued += chunks;
+    }
+    wake.notify_all();
+
+    std::unique_lock<std::mutex> lock(batch.mutex);
+    batch.done.wait(lock, [&] { return batch.remaining.load() == 0; });
+    if (batch.error) std::rethrow_exception(batch.error);
+}
+
+// Own deque from the front first, then steal from the back of the others
+bool ThreadPool::takeTask(std::size_t self, Task& task){
+    const std::size_t n = queues.size();
+    for (std::size_t k = 0; k < n; ++k) {
+        TaskQueue& queue = *queues[(self + k) % n];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) continue;
+        if (k == 0) {
+            task = queue.tasks.front();
+            queue.tasks.pop_front();
+        } else {
+            task = queue.tasks.back();
+            queue.tasks.pop_back();
+        }
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::run(const Task& task){
+    Batch& batch = *task.batch;
+    try {
+        (*batch.body)(task.begin, task.end);
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(batch.mutex);
+        if (!batch.error) batch.error = std::current_exception();
+    }
+    // Decrement and notify under the lock: the waiter can only observe zero once
+    // this thread has let go of the mutex, after which batch (on the waiter's stack) is never touched
+    std::lock_guard<std::mutex> lock(batch.mutex);
+    if (batch.remaining.fetch_sub(1) == 1) batch.done.notify_all();
+}
+
+void ThreadPool::workerLoop(std::size_t self){
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wake.wait(lock, [&] { return stopping || queued > 0; });
+            if (queued == 0) return; // stopping with nothing left to do
+            queued--; // claim one task; tasks are queued before they are counted, so one is waiting
+        }
+        Task task;
+        while (!takeTask(self, task)) std::this_thread::yield();
+        run(task);
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads with one task deque each. parallelFor() deals
+// contiguous chunks of an index range out to the deques; a worker drains its
+// own deque from the front and, once empty, steals from the back of the
+// others, so uneven chunks (long vs. short routes) still keep every core busy.
+class ThreadPool {
+    public:
+        using RangeFn = std::function<void(std::size_t begin, std::size_t end)>;
+
+        explicit ThreadPool(std::size_t threads = 0); // 0 = one per hardware thread
+        ~ThreadPool();
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        std::size_t size() const { return workers.size(); }
+
+        // Runs body over [0, count) in chunks of about grain indices (0 picks
+        // one) and returns once every chunk has finished, rethrowing the first
+        // exception a chunk threw. Must not be called from inside a task.
+        void parallelFor(std::size_t count, const RangeFn& body, std::size_t grain = 0);
+
+        // Process-wide pool sized to the hardware, created on first use
+        static ThreadPool& shared();
+
+    private:
+        struct Batch {
+            const RangeFn* body;
+            std::atomic<std::size_t> remaining{0};
+            std::mutex mutex;
+            std::condition_variable done;
+            std::exception_ptr error;
+        };
+        struct Task {
+            Batch* batch;
+            std::size_t begin;
+            std::size_t end;
+        };
+        struct TaskQueue {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        void workerLoop(std::size_t self);
+        bool takeTask(std::size_t self, Task& task);
+        static void run(const Task& task);
+
+        std::vector<std::unique_ptr<TaskQueue>> queues;
+        std::vector<std::thread> workers;
+
+        std::mutex sleepMutex;
+        std::condition_variable wake;
+        std::size_t queued = 0; // tasks waiting in any deque, guarded by sleepMutex
+        bool stopping = false;
+};
+
+#endif
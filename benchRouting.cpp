@@ -6,18 +6,110 @@
 #include <algorithm>
 #include <iomanip>
 #include <cassert>
+#include <chrono>
+#include <filesystem>
+#include <thread>
+#include <sys/resource.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 #include "CampusPathFinder/src/Graph.h"
+#include "CampusPathFinder/src/GeoBatch.h"
 #include "CampusPathFinder/src/Dijkstra.h"
 #include "CampusPathFinder/src/Astar.h"
+#include "CampusPathFinder/src/BidirectionalDijkstra.h"
+#include "CampusPathFinder/src/BidirectionalAstar.h"
+#include "CampusPathFinder/src/ContractionHierarchy.h"
+#include "CampusPathFinder/src/AltAstar.h"
+#include "CampusPathFinder/src/ThreadPool.h"
+#include "CampusPathFinder/src/DistanceMatrix.h"
+#include "CampusPathFinder/src/OneToAll.h"
+#include "CampusPathFinder/src/SpatialIndex.h"
+
+// L1d read misses and last-level cache misses of this thread between start()
+// and stop(). Linux only, and only where perf events are permitted
+// (perf_event_paranoid, containers); elsewhere available() is false.
+class CacheCounters {
+    public:
+        CacheCounters() {
+#ifdef __linux__
+            l1 = open(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                          (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+            llc = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+#endif
+        }
+        ~CacheCounters() {
+#ifdef __linux__
+            if (l1 >= 0) close(l1);
+            if (llc >= 0) close(llc);
+#endif
+        }
+        CacheCounters(const CacheCounters&) = delete;
+        CacheCounters& operator=(const CacheCounters&) = delete;
+
+        bool available() const { return l1 >= 0 && llc >= 0; }
+
+        void start() {
+#ifdef __linux__
+            for (int fd : {l1, llc}) {
+                if (fd < 0) continue;
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+#endif
+        }
+        void stop() {
+#ifdef __linux__
+            for (int fd : {l1, llc}) {
+                if (fd >= 0) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            }
+            if (l1 >= 0 && read(l1, &l1Misses, sizeof(l1Misses)) != sizeof(l1Misses)) l1Misses = 0;
+            if (llc >= 0 && read(llc, &llcMisses, sizeof(llcMisses)) != sizeof(llcMisses)) llcMisses = 0;
+#endif
+        }
+
+        std::uint64_t l1Misses = 0;
+        std::uint64_t llcMisses = 0;
+
+    private:
+#ifdef __linux__
+        static int open(std::uint32_t type, std::uint64_t config) {
+            perf_event_attr attr{};
+            attr.size = sizeof(attr);
+            attr.type = type;
+            attr.config = config;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+#endif
+        int l1 = -1;
+        int llc = -1;
+};
+
+// Peak resident set size of this process so far, in MB.
+static double peakRssMB() {
+    struct rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / (1024.0 * 1024.0); // bytes on macOS
+#else
+    return usage.ru_maxrss / 1024.0;            // kilobytes on Linux
+#endif
+}
 
 // Collecing node IDs from the graph so we can benchmark random pairs.
 static std::vector<std::string> collectNodeIds(const Graph& g, size_t maxNodes = 5000) {
     std::vector<std::string> ids;
-    ids.reserve(std::min(maxNodes, g.getList().size()));
+    ids.reserve(std::min(maxNodes, g.nodeCount()));
 
-    for (const auto& kv : g.getList()) {
-        ids.push_back(kv.first);
+    for (Graph::NodeId u : g.nodes()) {
+        ids.push_back(g.nodeName(u));
         if (ids.size() >= maxNodes) break;
     }
     return ids;
@@ -48,13 +140,19 @@ struct Stats {
     int trials = 0;
     int reachable = 0;
     double totalMs = 0.0;
+    double reachableMs = 0.0;
     double totalWeight = 0.0;
     double totalPathLen = 0.0;
+    double totalTouched = 0.0;
+    double totalSettled = 0.0;
 
     double avgMs() const { return trials ? totalMs / trials : 0.0; }
-    double avgMsReachable() const { return reachable ? totalMs / reachable : 0.0; }
+    double avgMsReachable() const { return reachable ? reachableMs / reachable : 0.0; }
+    double avgMsUnreachable() const { return trials > reachable ? (totalMs - reachableMs) / (trials - reachable) : 0.0; }
     double avgWeightReachable() const { return reachable ? totalWeight / reachable : 0.0; }
     double avgPathLenReachable() const { return reachable ? totalPathLen / reachable : 0.0; }
+    double avgTouched() const { return trials ? totalTouched / trials : 0.0; }
+    double avgSettled() const { return trials ? totalSettled / trials : 0.0; }
 };
 
 template <typename Algo>
@@ -66,9 +164,12 @@ static Stats runBench(Algo& algo,
     for (const auto& [s, t] : pairs) {
         auto res = algo.computePath(s, t);
         st.totalMs += res.elapsedMs;
+        st.totalTouched += (double)res.touchedNodes;
+        st.totalSettled += (double)res.settledNodes;
 
         if (res.reachable) {
             st.reachable++;
+            st.reachableMs += res.elapsedMs;
             st.totalWeight += res.weight;
             st.totalPathLen += (double)res.path.size();
         }
@@ -86,18 +187,516 @@ static void printStats(const std::string& name, const Stats& st) {
     std::cout << std::fixed << std::setprecision(4);
     std::cout << "Avg time (all):       " << st.avgMs() << " ms\n";
     std::cout << "Avg time (reachable): " << st.avgMsReachable() << " ms\n";
+    std::cout << "Avg time (unreachable): " << st.avgMsUnreachable() << " ms\n";
 
     std::cout << std::fixed << std::setprecision(3);
     std::cout << "Avg weight (reachable):   " << st.avgWeightReachable() << "\n";
     std::cout << "Avg path nodes (reachable): " << st.avgPathLenReachable() << "\n";
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "Avg touched nodes/query: " << st.avgTouched() << "\n";
+    std::cout << "Avg settled nodes/query: " << st.avgSettled() << "\n";
+}
+
+static void printSpeedup(const std::string& label, const Stats& base, const Stats& other) {
+    std::cout << std::fixed << std::setprecision(2) << label << ": ";
+    if (other.avgMs() > 0.0) std::cout << base.avgMs() / other.avgMs() << "x time";
+    if (other.avgSettled() > 0.0) std::cout << ", " << base.avgSettled() / other.avgSettled() << "x settled";
+    std::cout << "\n";
+}
+
+// Queue policy comparison: operation counts and per-query latency
+// (timed around computePath so unreachable queries count too).
+template <typename Engine>
+static void runQueueBench(const std::string& name, const std::shared_ptr<const Graph>& graph,
+                          const std::vector<std::pair<std::string, std::string>>& pairs) {
+    Engine engine(graph);
+    std::vector<double> latencies;
+    latencies.reserve(pairs.size());
+    for (const auto& [s, t] : pairs) {
+        auto begin = std::chrono::high_resolution_clock::now();
+        engine.computePath(s, t);
+        latencies.push_back(std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - begin).count());
+    }
+    std::sort(latencies.begin(), latencies.end());
+    double total = 0.0;
+    for (double ms : latencies) total += ms;
+
+    const QueueStats& q = engine.queueStats();
+    const double n = (double)pairs.size();
+    std::cout << std::left << std::setw(40) << name << std::right << std::fixed
+              << std::setprecision(1)
+              << std::setw(9) << q.pushes / n << std::setw(9) << q.decreaseKeys / n
+              << std::setw(9) << q.pops / n << std::setw(9) << q.stalePops / n
+              << std::setprecision(4)
+              << std::setw(10) << total / n
+              << std::setw(10) << latencies[latencies.size() / 2]
+              << std::setw(10) << latencies[latencies.size() * 99 / 100] << "\n";
+}
+
+template <template <typename> class Engine>
+static void runQueuePolicies(const std::string& engineName, const std::shared_ptr<const Graph>& graph,
+                             const std::vector<std::pair<std::string, std::string>>& pairs) {
+    runQueueBench<Engine<BinaryHeapQueue>>(engineName + " / " + BinaryHeapQueue::kName, graph, pairs);
+    runQueueBench<Engine<QuaternaryHeapQueue>>(engineName + " / " + QuaternaryHeapQueue::kName, graph, pairs);
+    runQueueBench<Engine<RadixHeapQueue>>(engineName + " / " + RadixHeapQueue::kName, graph, pairs);
+    runQueueBench<Engine<PairingHeapQueue>>(engineName + " / " + PairingHeapQueue::kName, graph, pairs);
+}
+
+// Throughput of one shared engine hammered from 1..N threads; each thread
+// takes every threadCount-th pair, so all runs answer the same query set.
+static void runThreadBench(const std::string& name, const ShortestPathBase& engine,
+                           const std::vector<std::pair<std::string, std::string>>& pairs) {
+    const unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned> counts = {1, 2, 4, 8};
+    if (hardware > 8) counts.push_back(hardware);
+
+    double baseline = 0.0;
+    for (unsigned threadCount : counts) {
+        auto begin = std::chrono::high_resolution_clock::now();
+        std::vector<std::thread> threads;
+        for (unsigned w = 0; w < threadCount; ++w) {
+            threads.emplace_back([&, w] {
+                for (std::size_t i = w; i < pairs.size(); i += threadCount) {
+                    engine.computePath(pairs[i].first, pairs[i].second);
+                }
+            });
+        }
+        for (auto& t : threads) t.join();
+        double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - begin).count();
+        double qps = pairs.size() / seconds;
+        if (threadCount == 1) baseline = qps;
+
+        std::cout << std::left << std::setw(24) << name << std::right << std::setw(8) << threadCount
+                  << std::fixed << std::setprecision(0) << std::setw(14) << qps
+                  << std::setprecision(2) << std::setw(10) << qps / baseline << "x"
+                  << std::setw(10) << qps / baseline / std::min(threadCount, hardware) << "\n";
+    }
+}
+
+// Batch throughput: the whole pair list through computePaths on pools of 1..N workers.
+static void runBatchBench(const std::string& name, const ShortestPathBase& engine,
+                          const std::vector<std::pair<Graph::NodeId, Graph::NodeId>>& queries) {
+    const unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned> counts = {1, 2, 4, 8};
+    if (hardware > 8) counts.push_back(hardware);
+
+    double baseline = 0.0;
+    for (unsigned threadCount : counts) {
+        ThreadPool pool(threadCount);
+        auto begin = std::chrono::high_resolution_clock::now();
+        auto results = engine.computePaths(queries, &pool);
+        double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - begin).count();
+        double qps = results.size() / seconds;
+        if (threadCount == 1) baseline = qps;
+
+        std::cout << std::left << std::setw(24) << name << std::right << std::setw(8) << threadCount
+                  << std::fixed << std::setprecision(0) << std::setw(14) << qps
+                  << std::setprecision(2) << std::setw(10) << qps / baseline << "x\n";
+    }
+}
+
+// size x size table: one-search-per-source matrix (sequential and on the shared
+// pool) against the naive loop of point-to-point Dijkstra queries. The naive
+// loop over a large table is timed on its first sampleRows rows and scaled up.
+static void runMatrixBench(const std::shared_ptr<const Graph>& graph, std::size_t size, std::size_t sampleRows) {
+    std::mt19937 rng(23);
+    std::uniform_int_distribution<Graph::NodeId> pick(0, (Graph::NodeId)graph->nodeCount() - 1);
+    std::vector<Graph::NodeId> sources(size), targets(size);
+    for (auto& v : sources) v = pick(rng);
+    for (auto& v : targets) v = pick(rng);
+
+    DistanceMatrix matrix(graph);
+    auto sequential = matrix.compute(sources, targets);
+    auto parallel = matrix.compute(sources, targets, &ThreadPool::shared());
+
+    Dijkstra dij(graph);
+    sampleRows = std::min(sampleRows, size);
+    auto begin = std::chrono::high_resolution_clock::now();
+    for (std::size_t r = 0; r < sampleRows; ++r) {
+        for (Graph::NodeId t : targets) dij.computePath(sources[r], t);
+    }
+    double naiveMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - begin).count() * size / sampleRows;
+
+    std::cout << std::fixed << std::setprecision(1)
+              << size << "x" << size << (sampleRows < size ? " (naive extrapolated from " + std::to_string(sampleRows) + " rows)" : "") << "\n"
+              << "  Naive computePath loop:  " << naiveMs << " ms\n"
+              << "  Matrix, sequential:      " << sequential.elapsedMs << " ms ("
+              << std::setprecision(0) << sequential.settledNodes / (double)size << " settled/source)\n"
+              << std::setprecision(1)
+              << "  Matrix, " << ThreadPool::shared().size() << " workers:      " << parallel.elapsedMs << " ms\n"
+              << std::setprecision(2)
+              << "  Speedup vs naive:        " << naiveMs / sequential.elapsedMs << "x sequential, "
+              << naiveMs / parallel.elapsedMs << "x parallel\n";
+}
+
+// Full trees and walking isochrones from random sources; the naive baseline
+// answers "which nodes are within 10 minutes" with one point query per node.
+static void runIsochroneBench(const std::shared_ptr<const Graph>& graph) {
+    OneToAll oneToAll(graph);
+    std::mt19937 rng(31);
+    std::uniform_int_distribution<Graph::NodeId> pick(0, (Graph::NodeId)graph->nodeCount() - 1);
+    std::vector<Graph::NodeId> sources(100);
+    for (auto& v : sources) v = pick(rng);
+
+    double treeMs = 0.0;
+    for (Graph::NodeId s : sources) treeMs += oneToAll.tree(s).elapsedMs;
+    std::cout << std::fixed << std::setprecision(3)
+              << "Full shortest-path tree:  " << treeMs / sources.size() << " ms/source\n";
+
+    for (double minutes : {5.0, 10.0, 15.0}) {
+        double ms = 0.0, nodes = 0.0;
+        for (Graph::NodeId s : sources) {
+            auto iso = oneToAll.walkingIsochrone(s, minutes);
+            ms += iso.elapsedMs;
+            nodes += iso.nodes.size();
+        }
+        std::cout << std::setprecision(0) << minutes << "-minute walk isochrone: "
+                  << std::setprecision(3) << ms / sources.size() << " ms/source, "
+                  << std::setprecision(1) << nodes / sources.size() << " nodes\n";
+    }
+
+    Dijkstra dij(graph);
+    const double radius = 10.0 * 60.0 * OneToAll::kWalkingSpeed;
+    auto begin = std::chrono::high_resolution_clock::now();
+    std::size_t within = 0;
+    for (Graph::NodeId v : graph->nodes()) {
+        auto res = dij.computePath(sources.front(), v);
+        within += res.reachable && res.weight <= radius;
+    }
+    double naiveMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - begin).count();
+    auto iso = oneToAll.walkingIsochrone(sources.front(), 10.0);
+    assert(within == iso.nodes.size());
+    std::cout << std::setprecision(1) << "Naive 10-minute set via " << graph->nodeCount() << " point queries: "
+              << naiveMs << " ms (" << std::setprecision(0) << naiveMs / std::max(iso.elapsedMs, 1e-6)
+              << "x the isochrone)\n";
+}
+
+static void runSnapBench(const std::shared_ptr<const Graph>& graph) {
+    double minLat = 90, maxLat = -90, minLon = 180, maxLon = -180;
+    for (Graph::NodeId v : graph->nodes()) {
+        minLat = std::min(minLat, graph->location(v).lat);
+        maxLat = std::max(maxLat, graph->location(v).lat);
+        minLon = std::min(minLon, graph->location(v).lon);
+        maxLon = std::max(maxLon, graph->location(v).lon);
+    }
+    std::mt19937 rng(37);
+    std::uniform_real_distribution<double> lat(minLat, maxLat), lon(minLon, maxLon);
+    std::vector<Graph::Coordinate> points(100000);
+    for (auto& p : points) p = {lat(rng), lon(rng)};
+
+    auto begin = std::chrono::high_resolution_clock::now();
+    SpatialIndex index;
+    index.build(*graph);
+    double buildMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - begin).count();
+    std::cout << std::fixed << std::setprecision(3) << "Index build: " << buildMs << " ms\n";
+
+    auto rate = [&](const char* label, std::size_t count, auto&& snap) {
+        std::uint64_t checksum = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (std::size_t i = 0; i < count; ++i) checksum += snap(points[i]);
+        double sec = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+        std::cout << std::left << std::setw(24) << label << std::right << std::setprecision(0)
+                  << std::setw(12) << count / sec << " snaps/s" << std::setprecision(3)
+                  << std::setw(10) << sec * 1e6 / count << " us/snap  (checksum " << checksum << ")\n";
+    };
+    rate("Nearest node", points.size(), [&](const Graph::Coordinate& p) { return graph->nearestNode(p.lat, p.lon); });
+    rate("Nearest edge point", points.size(), [&](const Graph::Coordinate& p) {
+        return graph->nearestEdgePoint(p.lat, p.lon).edge;
+    });
+    rate("Linear scan (node)", 200, [&](const Graph::Coordinate& p) {
+        Graph::NodeId best = 0;
+        double bestDist = std::numeric_limits<double>::infinity();
+        for (Graph::NodeId v : graph->nodes()) {
+            double dLat = graph->location(v).lat - p.lat;
+            double dLon = (graph->location(v).lon - p.lon) * std::cos(p.lat * M_PI / 180.0);
+            if (dLat * dLat + dLon * dLon < bestDist) {
+                bestDist = dLat * dLat + dLon * dLon;
+                best = v;
+            }
+        }
+        return best;
+    });
 }
 
-int main() {
+// Heuristic kernels in isolation (ns per evaluation against one goal), then A* with each
+static void runHeuristicBench(const std::shared_ptr<const Graph>& graph,
+                              const std::vector<std::pair<std::string, std::string>>& pairs) {
+    const Graph& g = *graph;
+    const Graph::NodeId goal = g.nodeId(pairs.front().second);
+    const int rounds = 20;
+    auto time = [&](const char* label, auto&& estimate) {
+        double sum = 0.0;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int r = 0; r < rounds; ++r) {
+            for (Graph::NodeId v : g.nodes()) sum += estimate(v);
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::high_resolution_clock::now() - start).count();
+        std::cout << std::left << std::setw(34) << label << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(8) << ns / (rounds * g.nodeCount()) << " ns/eval  (sum " << std::setprecision(0)
+                  << sum << ")\n";
+    };
+    const Graph::Coordinate& goalAt = g.location(goal);
+    time("Haversine on degrees (before)", [&](Graph::NodeId v) {
+        return Geo::haversine(g.location(v).lat, g.location(v).lon, goalAt.lat, goalAt.lon);
+    });
+    const Geo::Point& target = g.geoPoint(goal);
+    time("Great circle on cached radians", [&](Graph::NodeId v) { return Geo::greatCircle(g.geoPoint(v), target); });
+    time("Chord on cached xyz", [&](Graph::NodeId v) { return Geo::chord(g.geoPoint(v), target); });
+
+    // Batch kernels: every node against the goal, and every edge's length as at ingestion
+    std::vector<std::uint32_t> ids(g.nodeCount()), from, to;
+    for (Graph::NodeId v : g.nodes()) ids[v] = v;
+    for (Graph::NodeId u : g.nodes()) {
+        for (Graph::Neighbor edge : g.neighbors(u)) {
+            from.push_back(u);
+            to.push_back(edge.to);
+        }
+    }
+    std::vector<double> out(std::max(ids.size(), from.size()));
+    std::cout << "\n" << std::left << std::setw(12) << "Kernel" << std::right << std::setw(20) << "chord points/s"
+              << std::setw(20) << "arc segments/s" << "\n";
+    double scalarRate = 0.0;
+    for (auto kernel : {GeoBatch::Kernel::Scalar, GeoBatch::Kernel::Avx2, GeoBatch::Kernel::Avx512}) {
+        if (!GeoBatch::supported(kernel)) continue;
+        auto rate = [&](std::size_t items, auto&& run) {
+            auto start = std::chrono::high_resolution_clock::now();
+            for (int r = 0; r < rounds; ++r) run();
+            double sec = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+            return rounds * items / sec;
+        };
+        double chordRate = rate(ids.size(), [&] {
+            GeoBatch::chordDistances(g.geoPoints().data(), ids.data(), ids.size(), target, out.data(), kernel);
+        });
+        double arcRate = rate(from.size(), [&] {
+            GeoBatch::arcDistances(g.geoPoints().data(), from.data(), to.data(), from.size(), out.data(), kernel);
+        });
+        if (kernel == GeoBatch::Kernel::Scalar) scalarRate = chordRate;
+        std::cout << std::left << std::setw(12) << GeoBatch::name(kernel) << std::right << std::setprecision(0)
+                  << std::setw(20) << chordRate << std::setw(20) << arcRate << std::setprecision(2)
+                  << "   (chord " << chordRate / scalarRate << "x scalar)\n";
+    }
+
+    Astar chord(graph, AstarHeuristic::Chord);
+    Astar arc(graph, AstarHeuristic::GreatCircle);
+    auto chordStats = runBench(chord, pairs);
+    auto arcStats = runBench(arc, pairs);
+    std::cout << std::setprecision(4) << "\nA* (chord):        " << chordStats.avgMs() << " ms/query, "
+              << std::setprecision(1) << chordStats.avgSettled() << " settled\n"
+              << std::setprecision(4) << "A* (great circle): " << arcStats.avgMs() << " ms/query, "
+              << std::setprecision(1) << arcStats.avgSettled() << " settled\n";
+}
+
+// The same queries against the graph loaded under each node numbering
+static void runLayoutBench(const std::string& file, const std::vector<std::pair<std::string, std::string>>& pairs) {
+    CacheCounters counters;
+    if (!counters.available()) std::cout << "(hardware cache counters unavailable here; reporting time only)\n";
+    std::cout << std::left << std::setw(10) << "Order" << std::right << std::setw(10) << "ID gap"
+              << std::setw(14) << "Engine" << std::setw(10) << "avg ms" << std::setw(14) << "L1d miss/q"
+              << std::setw(14) << "LLC miss/q" << "\n";
+
+    const std::pair<Graph::NodeOrder, const char*> orders[] = {
+        {Graph::NodeOrder::Parse, "parse"}, {Graph::NodeOrder::Hilbert, "hilbert"}, {Graph::NodeOrder::Bfs, "bfs"}};
+    for (const auto& [order, label] : orders) {
+        auto graph = Graph::fromFile(file, order);
+        double gap = 0.0;
+        for (Graph::NodeId u : graph->nodes()) {
+            for (Graph::NodeId v : graph->neighborIds(u)) gap += u > v ? u - v : v - u;
+        }
+        gap /= graph->edgeCount();
+
+        auto report = [&](const char* engine, auto&& algo) {
+            runBench(algo, pairs); // warm the caches and scratch pools
+            counters.start();
+            auto st = runBench(algo, pairs);
+            counters.stop();
+            std::cout << std::left << std::setw(10) << label << std::right << std::fixed << std::setprecision(1)
+                      << std::setw(10) << gap << std::setw(14) << engine << std::setprecision(4)
+                      << std::setw(10) << st.avgMs() << std::setprecision(0);
+            if (counters.available()) {
+                std::cout << std::setw(14) << double(counters.l1Misses) / pairs.size()
+                          << std::setw(14) << double(counters.llcMisses) / pairs.size();
+            } else {
+                std::cout << std::setw(14) << "n/a" << std::setw(14) << "n/a";
+            }
+            std::cout << "\n";
+        };
+        report("Dijkstra", Dijkstra(graph));
+        report("A*", Astar(graph));
+    }
+}
+
+// Same queries on the parsed graph and on the chain-contracted one. Pairs are drawn
+// from the contracted graph's nodes, which exist in both.
+static void runChainBench(const std::string& file) {
+    auto start = std::chrono::high_resolution_clock::now();
+    auto full = Graph::fromFile(file);
+    auto mid = std::chrono::high_resolution_clock::now();
+    Graph::LoadOptions options;
+    options.contractChains = true;
+    auto contracted = Graph::fromFile(file, options);
+    auto end = std::chrono::high_resolution_clock::now();
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Nodes: " << full->nodeCount() << " -> " << contracted->nodeCount()
+              << ", directed edges: " << full->edgeCount() << " -> " << contracted->edgeCount() << "\n";
+    std::cout << "Load: " << std::chrono::duration<double, std::milli>(mid - start).count() << " ms -> "
+              << std::chrono::duration<double, std::milli>(end - mid).count() << " ms\n";
+
+    std::vector<std::string> names;
+    for (Graph::NodeId v : contracted->nodes()) names.push_back(contracted->nodeName(v));
+    auto pairs = makeRandomPairs(names, 5000, 7);
+
+    std::cout << std::left << std::setw(22) << "Engine" << std::right << std::setw(12) << "full ms"
+              << std::setw(12) << "chains ms" << std::setw(14) << "full settled" << std::setw(16) << "chains settled"
+              << "\n";
+    auto report = [&](const char* engine, auto&& onFull, auto&& onContracted) {
+        runBench(onFull, pairs); // warm scratch pools
+        runBench(onContracted, pairs);
+        auto a = runBench(onFull, pairs);
+        auto b = runBench(onContracted, pairs);
+        std::cout << std::left << std::setw(22) << engine << std::right << std::setprecision(4)
+                  << std::setw(12) << a.avgMs() << std::setw(12) << b.avgMs() << std::setprecision(1)
+                  << std::setw(14) << a.avgSettled() << std::setw(16) << b.avgSettled() << "\n";
+    };
+    report("Dijkstra", Dijkstra(full), Dijkstra(contracted));
+    report("A*", Astar(full), Astar(contracted));
+    report("Bidirectional A*", BidirectionalAstar(full), BidirectionalAstar(contracted));
+    report("Contraction Hierarchy", ContractionHierarchy(full), ContractionHierarchy(contracted));
+
+    // Re-expanding a route's full geometry is paid only by callers that want it
+    Dijkstra dijkstra(contracted);
+    std::vector<ShortestPathBase::PathResult> results;
+    for (const auto& [s, t] : pairs) results.push_back(dijkstra.computePath(s, t));
+    std::size_t points = 0;
+    auto expandStart = std::chrono::high_resolution_clock::now();
+    for (const auto& res : results) points += contracted->pathGeometry(res.path).size();
+    auto expandEnd = std::chrono::high_resolution_clock::now();
+    std::cout << std::setprecision(4) << "pathGeometry: "
+              << std::chrono::duration<double, std::milli>(expandEnd - expandStart).count() / results.size()
+              << " ms/route (" << std::setprecision(1) << double(points) / results.size() << " points)\n";
+}
+
+// Query cost and route shape per routing profile, all served by the same engines
+static void runProfileBench(const std::shared_ptr<const Graph>& graph,
+                            const std::vector<std::pair<std::string, std::string>>& pairs) {
+    const Graph& g = *graph;
+    using Profile = Graph::Profile;
+    Dijkstra dijkstra(graph);
+    Astar astar(graph);
+    AltAstar alt(graph);
+    std::cout << "Profile cost arrays: " << std::fixed << std::setprecision(3)
+              << g.profileWeightBytes() / 1e6 << " MB beside "
+              << g.edgeCount() * sizeof(double) / 1e6 << " MB of edge lengths\n";
+    std::cout << std::left << std::setw(12) << "Profile" << std::right << std::setw(11) << "reachable"
+              << std::setw(13) << "Dijkstra ms" << std::setw(9) << "A* ms" << std::setw(10) << "ALT ms"
+              << std::setw(10) << "settled" << std::setw(11) << "cost/m" << std::setw(11) << "detour" << "\n";
+    for (Profile profile : {Profile::Walking, Profile::Wheelchair, Profile::Bicycle, Profile::Night, Profile::Rain}) {
+        auto timed = [&](const ShortestPathBase& engine) {
+            double ms = 0.0;
+            for (const auto& [s, t] : pairs) ms += engine.computePath(s, t, profile).elapsedMs;
+            return ms / pairs.size();
+        };
+        // cost/m: profile cost per meter walked; detour: meters walked over the walking route's
+        std::size_t reachable = 0;
+        double settled = 0.0, cost = 0.0, meters = 0.0, shortest = 0.0;
+        for (const auto& [s, t] : pairs) {
+            auto res = astar.computePath(s, t, profile);
+            settled += res.settledNodes;
+            if (!res.reachable) continue;
+            reachable++;
+            cost += res.weight;
+            shortest += astar.computePath(s, t).weight;
+            for (std::size_t k = 0; k + 1 < res.path.size(); ++k) {
+                meters += g.edgeWeight(g.findEdge(g.nodeId(res.path[k]), g.nodeId(res.path[k + 1]), profile));
+            }
+        }
+        std::cout << std::left << std::setw(12) << RoutingProfile::name(profile) << std::right << std::setprecision(1)
+                  << std::setw(10) << 100.0 * reachable / pairs.size() << "%" << std::setprecision(4)
+                  << std::setw(13) << timed(dijkstra) << std::setw(9) << timed(astar) << std::setw(10) << timed(alt)
+                  << std::setprecision(1) << std::setw(10) << settled / pairs.size() << std::setprecision(3)
+                  << std::setw(11) << (meters > 0.0 ? cost / meters : 0.0)
+                  << std::setw(11) << (shortest > 0.0 ? meters / shortest : 0.0) << "\n";
+    }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    ContractionHierarchy night(graph, Profile::Night);
+    auto endTime = std::chrono::high_resolution_clock::now();
+    double ms = 0.0;
+    for (const auto& [s, t] : pairs) ms += night.computePath(s, t, Profile::Night).elapsedMs;
+    std::cout << "Contraction Hierarchy for night: " << std::setprecision(1)
+              << std::chrono::duration<double, std::milli>(endTime - startTime).count() << " ms to build, "
+              << std::setprecision(4) << ms / pairs.size() << " ms/query\n";
+}
+
+// Usage: benchRouting [queues|threads|matrix|isochrone|snap|heuristic|layout|chains|profiles]
+//   (no argument)  load, engine comparison and speedups
+//   queues         priority-queue policy comparison for Dijkstra and A*
+//   threads        queries/s of one shared engine per thread count, and of
+//                  computePaths batches on the work-stealing pool
+//   matrix         100x100 and 1000x1000 distance tables vs. the naive loop
+//   isochrone      shortest-path trees and walking isochrones vs. point queries
+//   snap           coordinate-to-node / edge snapping rate vs. a linear scan
+//   heuristic      A* heuristic cost per evaluation, scalar vs. SIMD batch kernels, and A* with each
+//   layout         query time and L1d / LLC misses under each node numbering
+//   chains         node / edge counts and query cost with degree-2 chains contracted
+//   profiles       query time, reachability and detours per routing profile
+int main(int argc, char** argv) {
     const std::string file = "data/ucla.geojson";
+    const std::string mode = argc > 1 ? argv[1] : "";
+    if (!mode.empty() && mode != "queues" && mode != "threads" && mode != "matrix" && mode != "isochrone" &&
+        mode != "snap" && mode != "heuristic" && mode != "layout" && mode != "chains" &&
+        mode != "profiles") {
+        std::cerr << "Unknown mode: " << mode
+                  << " (expected: queues, threads, matrix, isochrone, snap, heuristic, layout, chains, profiles)\n";
+        return 1;
+    }
+
+    // Load graph once; it is shared read-only by every engine below.
+    auto parseStart = std::chrono::high_resolution_clock::now();
+    auto graph = Graph::fromFile(file);
+    auto parseEnd = std::chrono::high_resolution_clock::now();
+    const double peakRssAfterParse = peakRssMB();
+    const Graph& g = *graph;
 
-    // Load graph once just to collect node IDs for random sampling.
-    Graph g;
-    g.loadFromFile(file);
+    // Compare against reopening the same graph from a binary snapshot.
+    const std::string snapshot =
+        (std::filesystem::temp_directory_path() / "benchRouting.snapshot").string();
+    graph->saveSnapshot(snapshot);
+    auto mapStart = std::chrono::high_resolution_clock::now();
+    auto mapped = Graph::fromSnapshot(snapshot);
+    auto mapEnd = std::chrono::high_resolution_clock::now();
+
+    std::cout << "== Load ==\n";
+    std::cout << "Nodes: " << g.nodeCount() << ", directed edges: " << g.edgeCount() << "\n";
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "GeoJSON parse:  "
+              << std::chrono::duration<double, std::milli>(parseEnd - parseStart).count() << " ms"
+              << " (" << g.loadStats().bytes / 1e6 << " MB, "
+              << g.loadStats().throughputMBps() << " MB/s streaming, "
+              << g.loadStats().features << " features)\n";
+    std::cout << "Cleanup: dropped " << g.loadStats().selfLoops << " self-loops, "
+              << g.loadStats().duplicateSegments << " duplicate segments, "
+              << g.loadStats().isolatedNodes << " isolated nodes\n";
+    {
+        std::size_t surfaced = 0, crossings = 0, named = 0;
+        for (Graph::EdgeId e = 0; e < g.edgeCount(); ++e) {
+            surfaced += g.edgeAttributes(e).surface() != EdgeAttributes::Surface::Unknown;
+            crossings += g.edgeAttributes(e).crossing() != EdgeAttributes::Crossing::None;
+            named += !g.edgeName(e).empty();
+        }
+        std::cout << "Edge tags: " << sizeof(EdgeAttributes) << " B/edge, surface on " << surfaced
+                  << ", crossing on " << crossings << ", name on " << named << " of " << g.edgeCount() << "\n";
+    }
+    std::cout << "Peak RSS after parse: " << peakRssAfterParse << " MB\n";
+    std::cout << "Snapshot mmap:  "
+              << std::chrono::duration<double, std::milli>(mapEnd - mapStart).count() << " ms"
+              << " (" << mapped->nodeCount() << " nodes)\n\n";
+    std::filesystem::remove(snapshot);
 
     auto nodeIds = collectNodeIds(g, 4000);
     std::cout << "Collected node IDs: " << nodeIds.size() << "\n";
@@ -111,15 +710,124 @@ int main() {
 
     auto pairs = makeRandomPairs(nodeIds, trials, seed);
 
-    Dijkstra dij(file);
-    Astar ast(file);
+    if (mode == "queues") {
+        std::cout << "\n== Priority queue policies (per query) ==\n";
+        std::cout << std::left << std::setw(40) << "Engine / queue" << std::right
+                  << std::setw(9) << "pushes" << std::setw(9) << "decKeys"
+                  << std::setw(9) << "pops" << std::setw(9) << "stale"
+                  << std::setw(10) << "avg ms" << std::setw(10) << "p50 ms" << std::setw(10) << "p99 ms" << "\n";
+        runQueuePolicies<BasicDijkstra>("Dijkstra", graph, pairs);
+        runQueuePolicies<BasicAstar>("A*", graph, pairs);
+        return 0;
+    }
+
+    if (mode == "matrix") {
+        std::cout << "\n== Distance matrix ==\n";
+        runMatrixBench(graph, 100, 100);
+        runMatrixBench(graph, 1000, 10);
+        return 0;
+    }
+
+    if (mode == "isochrone") {
+        std::cout << "\n== One-to-all ==\n";
+        runIsochroneBench(graph);
+        return 0;
+    }
+
+    if (mode == "snap") {
+        std::cout << "\n== Coordinate snapping ==\n";
+        runSnapBench(graph);
+        return 0;
+    }
+
+    if (mode == "heuristic") {
+        std::cout << "\n== A* heuristic ==\n";
+        runHeuristicBench(graph, pairs);
+        return 0;
+    }
+
+    if (mode == "layout") {
+        std::cout << "\n== Node numbering ==\n";
+        runLayoutBench(file, pairs);
+        return 0;
+    }
+
+    if (mode == "chains") {
+        std::cout << "\n== Degree-2 chain contraction ==\n";
+        runChainBench(file);
+        return 0;
+    }
+
+    if (mode == "profiles") {
+        std::cout << "\n== Routing profiles ==\n";
+        runProfileBench(graph, pairs);
+        return 0;
+    }
+
+    if (mode == "threads") {
+        std::cout << "\n== Concurrent queries on one shared engine ("
+                  << std::thread::hardware_concurrency() << " hardware threads) ==\n";
+        std::cout << std::left << std::setw(24) << "Engine" << std::right << std::setw(8) << "threads"
+                  << std::setw(14) << "queries/s" << std::setw(11) << "scaling" << std::setw(10) << "per core" << "\n";
+        runThreadBench("Dijkstra", Dijkstra(graph), pairs);
+        runThreadBench("A*", Astar(graph), pairs);
+        runThreadBench("ALT", AltAstar(graph), pairs);
+        runThreadBench("Contraction Hierarchy", ContractionHierarchy(graph), pairs);
+
+        std::vector<std::pair<Graph::NodeId, Graph::NodeId>> queries;
+        for (const auto& [s, t] : pairs) queries.push_back({g.nodeId(s), g.nodeId(t)});
+        std::cout << "\n== Batch computePaths on a work-stealing pool ==\n";
+        std::cout << std::left << std::setw(24) << "Engine" << std::right << std::setw(8) << "threads"
+                  << std::setw(14) << "queries/s" << std::setw(11) << "scaling" << "\n";
+        runBatchBench("Dijkstra", Dijkstra(graph), queries);
+        runBatchBench("ALT", AltAstar(graph), queries);
+        runBatchBench("Contraction Hierarchy", ContractionHierarchy(graph), queries);
+        return 0;
+    }
+
+    Dijkstra dij(graph);
+    Astar ast(graph);
+    BidirectionalDijkstra biDij(graph);
+    BidirectionalAstar biAst(graph);
+    ContractionHierarchy ch(graph);
+
+    std::cout << "\n== Contraction Hierarchy preprocessing ==\n";
+    std::cout << std::fixed << std::setprecision(1)
+              << "Build time: " << ch.sharedHierarchy()->buildMs << " ms, shortcuts: "
+              << ch.sharedHierarchy()->shortcuts << ", upward edges: "
+              << ch.sharedHierarchy()->upTargets.size() << "\n";
 
     // Run benchmarks
     auto dijStats = runBench(dij, pairs);
     auto astStats = runBench(ast, pairs);
+    auto biDijStats = runBench(biDij, pairs);
+    auto biAstStats = runBench(biAst, pairs);
+    auto chStats = runBench(ch, pairs);
+
+    // ALT: landmark count trades table memory for query speed
+    std::cout << "\n== ALT landmark sweep (avoid selection) ==\n";
+    std::cout << "   K   build ms   table KB   avg ms   settled   speedup vs Dijkstra\n";
+    Stats altStats;
+    for (std::size_t k : {1, 2, 4, 8, 16}) {
+        auto landmarks = AltAstar::selectLandmarks(g, k);
+        AltAstar alt(graph, landmarks);
+        auto st = runBench(alt, pairs);
+        std::cout << std::fixed << std::setprecision(1)
+                  << std::setw(4) << k << std::setw(11) << landmarks->buildMs
+                  << std::setw(11) << landmarks->bytes() / 1024.0
+                  << std::setprecision(4) << std::setw(9) << st.avgMs()
+                  << std::setprecision(1) << std::setw(10) << st.avgSettled()
+                  << std::setprecision(2) << std::setw(12)
+                  << (st.avgMs() > 0.0 ? dijStats.avgMs() / st.avgMs() : 0.0) << "x\n";
+        if (k == AltAstar::kDefaultLandmarks) altStats = st;
+    }
 
     printStats("Dijkstra", dijStats);
     printStats("A*", astStats);
+    printStats("Bidirectional Dijkstra", biDijStats);
+    printStats("Bidirectional A*", biAstStats);
+    printStats("Contraction Hierarchy", chStats);
+    printStats("ALT (K=" + std::to_string(AltAstar::kDefaultLandmarks) + ")", altStats);
 
     // Simple speedup report
     std::cout << "\n== Speedup ==\n";
@@ -130,6 +838,15 @@ int main() {
     } else {
         std::cout << "A* avg time is 0 (unexpected). Increase trials or check timing.\n";
     }
+    if (astStats.avgTouched() > 0.0) {
+        std::cout << std::fixed << std::setprecision(2)
+                  << "Dijkstra / A* touched-node ratio: "
+                  << dijStats.avgTouched() / astStats.avgTouched() << "x\n";
+    }
+    printSpeedup("Dijkstra / Bidirectional Dijkstra", dijStats, biDijStats);
+    printSpeedup("A* / Bidirectional A*", astStats, biAstStats);
+    printSpeedup("Dijkstra / Contraction Hierarchy", dijStats, chStats);
+    printSpeedup("A* / ALT", astStats, altStats);
 
     return 0;
 }
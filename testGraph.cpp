@@ -3,30 +3,34 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include "CampusPathFinder/src/Checksum.h"
 #include "CampusPathFinder/src/Dijkstra.h"
 #include "CampusPathFinder/src/Graph.h"
 
 // Helper: pick two valid nodes from the loaded graph.
 static std::pair<std::string, std::string> pickTwoNodes(const Graph& g) {
-    auto list = g.getList();
-    assert(!list.empty());
+    assert(g.nodeCount() > 0);
 
-    std::string start, end;
-
-    // first node that has at least 1 neighbor
-    for (const auto& kv : list) {
-        if (!kv.second.empty()) {
-            start = kv.first;
+    // start: first node that has at least 1 neighbor
+    Graph::NodeId start = Graph::kInvalidNode;
+    for (Graph::NodeId u : g.nodes()) {
+        if (!g.neighbors(u).empty()) {
+            start = u;
             break;
         }
     }
-    assert(!start.empty());
+    assert(start != Graph::kInvalidNode);
 
     // end: a neighbor of start (guarantees reachable in an undirected segment)
-    end = list[start].front().first;
-    assert(!end.empty());
+    Graph::NodeId end = (*g.neighbors(start).begin()).to;
 
-    return {start, end};
+    return {g.nodeName(start), g.nodeName(end)};
 }
 
 static void testReachableSimple() {
@@ -57,12 +61,8 @@ static void testSameStartEnd() {
     g.loadFromFile("data/ucla.geojson");
 
     // pick any valid node
-    std::string node;
-    for (const auto& kv : g.getList()) {
-        node = kv.first;
-        break;
-    }
-    assert(!node.empty());
+    assert(g.nodeCount() > 0);
+    std::string node = g.nodeName(*g.nodes().begin());
 
     Dijkstra d("data/ucla.geojson");
     auto res = d.computePath(node, node);
@@ -119,6 +119,587 @@ static void testPathIsContinuousEdges() {
     std::cout << "PASS: testPathIsContinuousEdges\n";
 }
 
+static void testNeighborViewsMatchWrappers() {
+    Graph g;
+    g.loadFromFile("data/ucla.geojson");
+
+    size_t edges = 0;
+    for (Graph::NodeId u : g.nodes()) {
+        auto copied = g.getNeighbors(g.nodeName(u));
+        auto ids = g.neighborIds(u);
+        auto weights = g.neighborWeights(u);
+        assert(copied.size() == g.neighbors(u).size());
+        assert(ids.size() == copied.size() && weights.size() == copied.size());
+
+        size_t i = 0;
+        for (Graph::Neighbor edge : g.neighbors(u)) {
+            assert(edge.to == ids[i] && edge.weight == weights[i]);
+            assert(g.nodeName(edge.to) == copied[i].first);
+            assert(edge.weight == copied[i].second);
+            ++i;
+        }
+        edges += i;
+    }
+    assert(edges == g.edgeCount());
+
+    std::cout << "PASS: testNeighborViewsMatchWrappers\n";
+}
+
+static void testExactNodeKeys() {
+    Graph g;
+    g.loadFromFile("data/ucla.geojson");
+
+    // Every node name parses back to the same key and ID
+    for (Graph::NodeId u : g.nodes()) {
+        Graph::NodeKey key = 0;
+        assert(Graph::parseKey(g.nodeName(u), key));
+        assert(key == g.nodeKey(u));
+        assert(g.nodeId(g.nodeName(u)) == u);
+    }
+
+    // Points 1e-7 degrees apart stay distinct (six-decimal formatting merged them)
+    Graph::NodeKey a = Graph::coordinateKey(34.0709968, -118.4449600);
+    Graph::NodeKey b = Graph::coordinateKey(34.0709969, -118.4449600);
+    assert(a != b);
+    assert(Graph::formatKey(a) == "34.0709968,-118.4449600");
+    assert(Graph::keyCoordinate(a).lat == 34.0709968);
+
+    Graph::NodeKey parsed = 0;
+    assert(Graph::parseKey("34.0709968,-118.44496", parsed) && parsed == a);
+    assert(!Graph::parseKey("NOT_A_REAL_NODE", parsed));
+    assert(!Graph::parseKey("34.07,", parsed));
+
+    std::cout << "PASS: testExactNodeKeys\n";
+}
+
+static void testSnapshotRoundTrip() {
+    Graph g;
+    g.loadFromFile("data/ucla.geojson");
+
+    const std::string path =
+        (std::filesystem::temp_directory_path() / "testGraph.snapshot").string();
+    g.saveSnapshot(path);
+
+    auto mapped = Graph::fromSnapshot(path);
+    assert(mapped->isMapped());
+    assert(mapped->nodeCount() == g.nodeCount());
+    assert(mapped->edgeCount() == g.edgeCount());
+
+    for (Graph::NodeId u : g.nodes()) {
+        assert(mapped->nodeName(u) == g.nodeName(u));
+        assert(mapped->nodeId(g.nodeName(u)) == u);
+        assert(mapped->location(u).lat == g.location(u).lat);
+        assert(mapped->location(u).lon == g.location(u).lon);
+
+        auto a = g.neighborIds(u), b = mapped->neighborIds(u);
+        auto wa = g.neighborWeights(u), wb = mapped->neighborWeights(u);
+        assert(std::equal(a.begin(), a.end(), b.begin(), b.end()));
+        assert(std::equal(wa.begin(), wa.end(), wb.begin(), wb.end()));
+    }
+
+    auto [start, end] = pickTwoNodes(g);
+    Dijkstra fromJson("data/ucla.geojson");
+    Dijkstra fromSnapshot(mapped);
+    auto r1 = fromJson.computePath(start, end);
+    auto r2 = fromSnapshot.computePath(start, end);
+    assert(r1.reachable && r2.reachable);
+    assert(r1.path == r2.path && r1.weight == r2.weight);
+
+    // Flip one payload byte mid-file (the trailing sections are small and end in padding);
+    // checksum verification must reject it
+    {
+        std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+        f.seekg(0, std::ios::end);
+        std::streamoff size = f.tellg();
+        f.seekg(size / 2);
+        char c = 0;
+        f.read(&c, 1);
+        c = static_cast<char>(c ^ 0x5a);
+        f.seekp(size / 2);
+        f.write(&c, 1);
+    }
+    bool threw = false;
+    try {
+        Graph corrupt;
+        corrupt.loadSnapshot(path);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw && "Corrupted snapshot was accepted!");
+
+    // An edge target past the last node is rejected even with checksums off. Header:
+    // sectionCount at byte 32; table at 48, 32-byte entries {id, size, offset, ...}
+    g.saveSnapshot(path);
+    {
+        std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+        std::uint32_t sections = 0;
+        f.seekg(32);
+        f.read(reinterpret_cast<char*>(&sections), sizeof(sections));
+        for (std::uint32_t i = 0; i < sections; ++i) {
+            std::uint32_t id = 0;
+            std::uint64_t offset = 0;
+            f.seekg(48 + 32 * i);
+            f.read(reinterpret_cast<char*>(&id), sizeof(id));
+            f.seekg(48 + 32 * i + 8);
+            f.read(reinterpret_cast<char*>(&offset), sizeof(offset));
+            if (id != 3) continue; // targets
+            const auto target = static_cast<Graph::NodeId>(g.nodeCount());
+            f.seekp(static_cast<std::streamoff>(offset));
+            f.write(reinterpret_cast<const char*>(&target), sizeof(target));
+        }
+    }
+    threw = false;
+    try {
+        Graph corrupt;
+        corrupt.loadSnapshot(path, false);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw && "Out-of-range edge target was accepted!");
+
+    // A section whose offset + size wraps around 2^64 is caught by the bounds
+    // check, even though the section table's own checksum is made to match
+    g.saveSnapshot(path);
+    {
+        std::ifstream in(path, std::ios::binary);
+        std::vector<char> file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        in.close();
+        std::uint32_t sections = 0;
+        std::memcpy(&sections, file.data() + 32, sizeof(sections));
+        for (std::uint32_t i = 0; i < sections; ++i) {
+            std::uint32_t id = 0;
+            std::memcpy(&id, file.data() + 48 + 32 * i, sizeof(id));
+            if (id != 3) continue; // targets
+            const std::uint64_t offset = ~std::uint64_t{63}; // aligned, and offset + bytes wraps
+            std::memcpy(file.data() + 48 + 32 * i + 8, &offset, sizeof(offset));
+        }
+        const std::uint64_t checksum = fnv1a(file.data() + 48, std::size_t{sections} * 32);
+        std::memcpy(file.data() + 40, &checksum, sizeof(checksum));
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(file.data(), static_cast<std::streamsize>(file.size()));
+    }
+    threw = false;
+    try {
+        Graph corrupt;
+        corrupt.loadSnapshot(path, false);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw && "Wrapping section bounds were accepted!");
+    std::filesystem::remove(path);
+
+    std::cout << "PASS: testSnapshotRoundTrip\n";
+}
+
+// Mean |u - v| over all edges: small when neighbors get nearby IDs
+static double meanIdGap(const Graph& g) {
+    double gap = 0.0;
+    for (Graph::NodeId u : g.nodes()) {
+        for (Graph::NodeId v : g.neighborIds(u)) gap += u > v ? u - v : v - u;
+    }
+    return gap / g.edgeCount();
+}
+
+static void testNodeOrders() {
+    Graph parsed;
+    parsed.loadFromFile("data/ucla.geojson", Graph::NodeOrder::Parse);
+
+    for (auto order : {Graph::NodeOrder::Hilbert, Graph::NodeOrder::Bfs}) {
+        Graph g;
+        g.loadFromFile("data/ucla.geojson", order);
+        assert(g.nodeCount() == parsed.nodeCount() && g.edgeCount() == parsed.edgeCount());
+
+        // Same nodes, same neighbors in the same order, only the IDs differ
+        for (Graph::NodeId u : parsed.nodes()) {
+            Graph::NodeId w = g.nodeId(parsed.nodeKey(u));
+            assert(w != Graph::kInvalidNode);
+            assert(g.location(w).lat == parsed.location(u).lat && g.location(w).lon == parsed.location(u).lon);
+            auto a = parsed.neighbors(u);
+            auto b = g.neighbors(w);
+            assert(a.size() == b.size());
+            for (auto ia = a.begin(), ib = b.begin(); ia != a.end(); ++ia, ++ib) {
+                assert(g.nodeKey((*ib).to) == parsed.nodeKey((*ia).to));
+                assert((*ib).weight == (*ia).weight);
+            }
+        }
+        assert(meanIdGap(g) < meanIdGap(parsed));
+    }
+
+    std::cout << "PASS: testNodeOrders\n";
+}
+
+static void testComponents() {
+    Graph g;
+    g.loadFromFile("data/ucla.geojson");
+    assert(g.componentCount() > 0);
+
+    // Labels agree with a plain flood fill from the lowest unvisited node
+    std::vector<Graph::ComponentId> label(g.nodeCount(), Graph::kInvalidNode);
+    Graph::ComponentId next = 0;
+    for (Graph::NodeId s : g.nodes()) {
+        if (label[s] != Graph::kInvalidNode) continue;
+        std::vector<Graph::NodeId> stack{s};
+        label[s] = next;
+        while (!stack.empty()) {
+            Graph::NodeId u = stack.back();
+            stack.pop_back();
+            for (Graph::NodeId v : g.neighborIds(u)) {
+                if (label[v] == Graph::kInvalidNode) {
+                    label[v] = next;
+                    stack.push_back(v);
+                }
+            }
+        }
+        next++;
+    }
+    assert(next == g.componentCount());
+
+    std::size_t total = 0;
+    std::size_t largestSize = 0;
+    for (Graph::ComponentId c = 0; c < g.componentCount(); ++c) {
+        total += g.componentSize(c);
+        largestSize = std::max(largestSize, g.componentSize(c));
+    }
+    assert(total == g.nodeCount());
+    assert(g.componentSize(g.largestComponent()) == largestSize);
+    for (Graph::NodeId u : g.nodes()) assert(g.componentOf(u) == label[u]);
+
+    // Snapshot loads rebuild the same labels
+    const std::string path =
+        (std::filesystem::temp_directory_path() / "testComponents.snapshot").string();
+    g.saveSnapshot(path);
+    auto mapped = Graph::fromSnapshot(path);
+    assert(mapped->componentCount() == g.componentCount());
+    for (Graph::NodeId u : g.nodes()) assert(mapped->componentOf(u) == g.componentOf(u));
+    std::filesystem::remove(path);
+
+    std::cout << "PASS: testComponents (" << g.componentCount() << " components)\n";
+}
+
+static double polylineMeters(const std::vector<Graph::Coordinate>& points) {
+    double meters = 0.0;
+    for (std::size_t i = 1; i < points.size(); ++i) {
+        meters += Geo::haversine(points[i - 1].lat, points[i - 1].lon, points[i].lat, points[i].lon);
+    }
+    return meters;
+}
+
+static void testChainContraction() {
+    auto full = Graph::fromFile("data/ucla.geojson");
+    Graph::LoadOptions options;
+    options.contractChains = true;
+    auto contracted = Graph::fromFile("data/ucla.geojson", options);
+
+    assert(!full->hasShapes() && contracted->hasShapes());
+    assert(contracted->nodeCount() < full->nodeCount() && contracted->edgeCount() < full->edgeCount());
+    assert(contracted->loadStats().parsedNodes == full->nodeCount());
+    assert(contracted->loadStats().parsedEdges == full->edgeCount());
+    assert(contracted->componentCount() == full->componentCount());
+
+    // Kept nodes keep their degree; each edge walks degree-2 shape points and weighs its polyline
+    Graph::NodeId shapedFrom = Graph::kInvalidNode;
+    Graph::EdgeId shaped = Graph::kInvalidEdge;
+    for (Graph::NodeId v : contracted->nodes()) {
+        Graph::NodeId w = full->nodeId(contracted->nodeKey(v));
+        assert(w != Graph::kInvalidNode);
+        assert(contracted->neighbors(v).size() == full->neighbors(w).size());
+        for (Graph::Neighbor edge : contracted->neighbors(v)) {
+            auto line = contracted->edgeGeometry(v, edge.edge);
+            assert(line.size() == contracted->edgePointCount(edge.edge));
+            assert(std::abs(polylineMeters(line) - edge.weight) < 1e-6 * std::max(1.0, edge.weight));
+            for (std::size_t i = 1; i + 1 < line.size(); ++i) {
+                Graph::NodeId inner = full->nodeId(Graph::coordinateKey(line[i].lat, line[i].lon));
+                assert(inner != Graph::kInvalidNode && full->neighbors(inner).size() == 2);
+                assert(contracted->nodeId(Graph::coordinateKey(line[i].lat, line[i].lon)) == Graph::kInvalidNode);
+            }
+            if (line.size() > 3 && shaped == Graph::kInvalidEdge) {
+                shapedFrom = v;
+                shaped = edge.edge;
+            }
+        }
+    }
+    assert(shaped != Graph::kInvalidEdge);
+
+    // Partial stretches are measured along the polyline, and reverse cleanly
+    auto middle = contracted->edgeGeometry(shapedFrom, shaped, 0.25, 0.75);
+    auto backwards = contracted->edgeGeometry(shapedFrom, shaped, 0.75, 0.25);
+    assert(std::abs(polylineMeters(middle) - 0.5 * contracted->edgeWeight(shaped)) < 1e-6 * contracted->edgeWeight(shaped));
+    assert(std::equal(middle.begin(), middle.end(), backwards.rbegin(), backwards.rend(),
+                      [](const Graph::Coordinate& a, const Graph::Coordinate& b) { return a.lat == b.lat && a.lon == b.lon; }));
+
+    // Same shortest distances between kept nodes, and the expanded path is the full graph's path
+    Dijkstra fullDijkstra(full), contractedDijkstra(contracted);
+    std::size_t fullSettled = 0, contractedSettled = 0;
+    for (Graph::NodeId v = 0; v < contracted->nodeCount(); v += 37) {
+        Graph::NodeId t = static_cast<Graph::NodeId>((v * 7919u + 13) % contracted->nodeCount());
+        auto a = fullDijkstra.computePath(contracted->nodeName(v), contracted->nodeName(t));
+        auto b = contractedDijkstra.computePath(v, t);
+        assert(a.reachable == b.reachable);
+        fullSettled += a.settledNodes;
+        contractedSettled += b.settledNodes;
+        if (!a.reachable) continue;
+        assert(std::abs(a.weight - b.weight) < 1e-6 * std::max(1.0, a.weight));
+        auto expanded = contracted->pathGeometry(b.path);
+        assert(expanded.size() == a.path.size());
+        assert(std::abs(polylineMeters(expanded) - b.weight) < 1e-6 * std::max(1.0, b.weight));
+        auto reference = full->pathGeometry(a.path);
+        for (std::size_t i = 0; i < expanded.size(); ++i) {
+            assert(expanded[i].lat == reference[i].lat && expanded[i].lon == reference[i].lon);
+        }
+    }
+    assert(contractedSettled < fullSettled);
+
+    // Removed shape points still snap exactly onto their contracted edge
+    for (Graph::NodeId w = 0; w < full->nodeCount(); w += 53) {
+        if (contracted->nodeId(full->nodeKey(w)) != Graph::kInvalidNode) continue;
+        const Graph::Coordinate& at = full->location(w);
+        auto point = contracted->nearestEdgePoint(at.lat, at.lon);
+        assert(contracted->isValid(point) && point.distance < 0.01);
+        auto onEdge = contracted->edgeGeometry(point.from, point.edge, point.fraction, point.fraction).front();
+        assert(std::abs(onEdge.lat - at.lat) < 1e-7 && std::abs(onEdge.lon - at.lon) < 1e-7);
+    }
+
+    // Shapes survive a snapshot round trip
+    const std::string path =
+        (std::filesystem::temp_directory_path() / "testChains.snapshot").string();
+    contracted->saveSnapshot(path);
+    auto mapped = Graph::fromSnapshot(path);
+    assert(mapped->hasShapes() && mapped->edgeCount() == contracted->edgeCount());
+    for (Graph::NodeId v : contracted->nodes()) {
+        for (Graph::EdgeId e = contracted->edgeBegin(v); e < contracted->edgeEnd(v); ++e) {
+            auto a = contracted->edgeGeometry(v, e), b = mapped->edgeGeometry(v, e);
+            assert(a.size() == b.size());
+            for (std::size_t i = 0; i < a.size(); ++i) assert(a[i].lat == b[i].lat && a[i].lon == b[i].lon);
+        }
+    }
+    std::filesystem::remove(path);
+
+    std::cout << "PASS: testChainContraction (" << full->nodeCount() << " -> " << contracted->nodeCount()
+              << " nodes, " << full->edgeCount() << " -> " << contracted->edgeCount() << " edges)\n";
+}
+
+static void testMixedGeometries() {
+    // A Point, a Polygon and a MultiPoint around one LineString: only the line becomes edges
+    const std::string path = (std::filesystem::temp_directory_path() / "testMixed.geojson").string();
+    {
+        std::ofstream out(path);
+        out << R"({"type": "FeatureCollection", "features": [
+            {"type": "Feature", "geometry": {"type": "Point", "coordinates": [-118.0, 34.0]}},
+            {"type": "Feature", "geometry": {"coordinates": [[-118.4400, 34.0700], [-118.4390, 34.0700]],
+                "type": "LineString"}},
+            {"type": "Feature", "geometry": {"type": "Polygon", "coordinates":
+                [[[-118.43, 34.07], [-118.42, 34.07], [-118.42, 34.08], [-118.43, 34.07]]]}},
+            {"type": "Feature", "geometry": {"type": "MultiPoint", "coordinates": [[-118.41, 34.06], [-118.40, 34.06]]}},
+            {"type": "Feature", "geometry": {"type": "Point", "coordinates": [-118.1, 34.1]}}
+        ]})";
+    }
+    Graph g;
+    g.loadFromFile(path);
+    assert(g.nodeCount() == 2 && g.edgeCount() == 2);
+    assert(g.containsNode("34.0700000,-118.4400000") && g.containsNode("34.0700000,-118.4390000"));
+    assert(!g.containsNode("34.0000000,-118.0000000"));
+    std::filesystem::remove(path);
+
+    std::cout << "PASS: testMixedGeometries\n";
+}
+
+static void testCleanup() {
+    // A repeated point, the same segment drawn twice, a way ending ~0.3 m short
+    // of another, and a feature that is a single point twice over
+    const std::string path = (std::filesystem::temp_directory_path() / "testCleanup.geojson").string();
+    {
+        std::ofstream out(path);
+        out << R"({"type": "FeatureCollection", "features": [
+            {"type": "Feature", "geometry": {"type": "LineString", "coordinates":
+                [[-118.4400, 34.0700], [-118.4400, 34.0700], [-118.4390, 34.0700]]}},
+            {"type": "Feature", "geometry": {"type": "LineString", "coordinates":
+                [[-118.4390, 34.0700], [-118.4400, 34.0700]]}},
+            {"type": "Feature", "geometry": {"type": "LineString", "coordinates":
+                [[-118.4390, 34.070003], [-118.4380, 34.0710]]}},
+            {"type": "Feature", "geometry": {"type": "LineString", "coordinates":
+                [[-118.4300, 34.0800], [-118.4300, 34.0800]]}}
+        ]})";
+    }
+
+    Graph plain;
+    plain.loadFromFile(path);
+    assert(plain.loadStats().selfLoops == 2);
+    assert(plain.loadStats().duplicateSegments == 1);
+    assert(plain.loadStats().isolatedNodes == 1);
+    assert(plain.loadStats().weldedNodes == 0);
+    assert(plain.nodeCount() == 4 && plain.edgeCount() == 4);
+    assert(plain.componentCount() == 2);
+
+    Graph welded;
+    welded.loadFromFile(path, Graph::LoadOptions{Graph::NodeOrder::Parse, false, 0.5});
+    assert(welded.loadStats().weldedNodes == 1);
+    assert(welded.nodeCount() == 3 && welded.edgeCount() == 4);
+    assert(welded.componentCount() == 1);
+    // The survivor keeps its own coordinates; the welded node's name no longer resolves
+    assert(welded.containsNode("34.0700000,-118.4390000"));
+    assert(!welded.containsNode("34.0700030,-118.4390000"));
+    std::filesystem::remove(path);
+
+    // On the campus data a 0.5 m weld joins ways that stop just short of each other
+    Graph campus;
+    campus.loadFromFile("data/ucla.geojson", Graph::LoadOptions{Graph::NodeOrder::Hilbert, false, 0.5});
+    Graph reference;
+    reference.loadFromFile("data/ucla.geojson");
+    assert(campus.loadStats().weldedNodes > 0);
+    assert(campus.componentCount() < reference.componentCount());
+    for (Graph::NodeId v : campus.nodes()) assert(reference.nodeId(campus.nodeKey(v)) != Graph::kInvalidNode);
+
+    std::cout << "PASS: testCleanup\n";
+}
+
+static void testEdgeAttributes() {
+    using A = EdgeAttributes;
+    A tags;
+    tags.applyTag("highway", "steps");
+    tags.applyTag("crossing:signals", "yes");
+    tags.applyTag("crossing", "marked"); // a later, weaker reading does not downgrade the crossing
+    tags.applyTag("incline", "-8%");
+    tags.applyTag("layer", "-1");
+    tags.applyTag("wheelchair", "limited");
+    tags.applyTag("segregated", "no");
+    tags.applyTag("colour", "red");
+    assert(tags.highway() == A::Highway::Steps && tags.crossing() == A::Crossing::Signals);
+    assert(tags.incline() == A::Incline::Down && tags.reversed().incline() == A::Incline::Up);
+    assert(tags.layer() == -1 && tags.wheelchair() == A::Answer::Limited && tags.segregated() == A::Answer::No);
+    assert(tags.reversed().reversed() == tags && A::fromBits(tags.bits()) == tags);
+    tags.setLayer(9);
+    assert(tags.layer() == 3 && tags.highway() == A::Highway::Steps);
+    assert(A() == A::fromBits(0) && A().access() == A::Access::Yes);
+
+    // Numeric inclines keep how steep they are, the same both ways
+    auto graded = [](const char* incline) {
+        A a;
+        a.applyTag("incline", incline);
+        return a;
+    };
+    assert(graded("2%").grade() == A::Grade::Gentle && graded("-4.5%").grade() == A::Grade::Moderate);
+    assert(graded("8%").grade() == A::Grade::Steep && graded("-12%").grade() == A::Grade::VerySteep);
+    assert(graded("5°").grade() == A::Grade::VerySteep && graded("up").grade() == A::Grade::Unknown);
+    assert(tags.grade() == A::Grade::Steep && tags.reversed().grade() == A::Grade::Steep);
+
+    // Two ways meeting at a node: a named, tagged one and an untagged one
+    const std::string path = (std::filesystem::temp_directory_path() / "testAttributes.geojson").string();
+    {
+        std::ofstream out(path);
+        out << R"({"type": "FeatureCollection", "features": [
+            {"type": "Feature", "properties": {"highway": "footway", "name": "Bruin Walk", "incline": "up",
+                "surface": "paving_stones", "layer": -1, "crossing": "traffic_signals", "lit": "yes"},
+             "geometry": {"type": "LineString", "coordinates":
+                [[-118.4400, 34.0700], [-118.4390, 34.0700], [-118.4380, 34.0700]]}},
+            {"type": "Feature", "properties": {},
+             "geometry": {"type": "LineString", "coordinates": [[-118.4380, 34.0700], [-118.4380, 34.0710]]}}
+        ]})";
+    }
+    for (bool contract : {false, true}) {
+        Graph::LoadOptions options;
+        options.contractChains = contract;
+        Graph g;
+        g.loadFromFile(path, options);
+        // The middle node is kept only when chains are not contracted
+        assert(g.nodeCount() == (contract ? 3u : 4u));
+        const Graph::NodeId west = g.nodeId(Graph::coordinateKey(34.0700, -118.4400));
+        const Graph::NodeId middle = g.nodeId(Graph::coordinateKey(34.0700, -118.4390));
+        const Graph::NodeId corner = g.nodeId(Graph::coordinateKey(34.0700, -118.4380));
+        const Graph::NodeId north = g.nodeId(Graph::coordinateKey(34.0710, -118.4380));
+        const Graph::NodeId next = contract ? corner : middle;
+        const Graph::EdgeId uphill = g.findEdge(west, next);
+        const A a = g.edgeAttributes(uphill);
+        assert(a.highway() == A::Highway::Footway && a.surface() == A::Surface::PavingStones);
+        assert(a.incline() == A::Incline::Up && a.layer() == -1 && a.lit() == A::Answer::Yes);
+        assert(a.crossing() == A::Crossing::Signals);
+        assert(g.edgeName(uphill) == "Bruin Walk");
+        const Graph::EdgeId downhill = g.findEdge(next, west);
+        assert(g.edgeAttributes(downhill) == a.reversed() && g.edgeName(downhill) == "Bruin Walk");
+        const Graph::EdgeId plain = g.findEdge(corner, north);
+        assert(g.edgeAttributes(plain) == A() && g.edgeName(plain).empty());
+    }
+    std::filesystem::remove(path);
+
+    // Numbers and booleans are tags too. Of two copies of a segment the more
+    // tagged one stands, whichever came first; a tie keeps the first.
+    {
+        std::ofstream out(path);
+        out << R"({"type": "FeatureCollection", "features": [
+            {"type": "Feature", "properties": {"highway": "footway", "layer": 1, "incline": 8.5,
+                "covered": true, "bridge": false},
+             "geometry": {"type": "LineString", "coordinates": [[-118.4400, 34.0700], [-118.4390, 34.0700]]}},
+            {"type": "Feature", "properties": {"highway": "path"},
+             "geometry": {"type": "LineString", "coordinates": [[-118.4390, 34.0700], [-118.4400, 34.0700]]}},
+            {"type": "Feature", "properties": {"highway": "path"},
+             "geometry": {"type": "LineString", "coordinates": [[-118.4400, 34.0710], [-118.4390, 34.0710]]}},
+            {"type": "Feature", "properties": {"highway": "steps", "name": "Janss Steps"},
+             "geometry": {"type": "LineString", "coordinates": [[-118.4390, 34.0710], [-118.4400, 34.0710]]}},
+            {"type": "Feature", "properties": {"highway": "path"},
+             "geometry": {"type": "LineString", "coordinates": [[-118.4400, 34.0720], [-118.4390, 34.0720]]}},
+            {"type": "Feature", "properties": {"highway": "steps"},
+             "geometry": {"type": "LineString", "coordinates": [[-118.4400, 34.0720], [-118.4390, 34.0720]]}}
+        ]})";
+    }
+    {
+        Graph g;
+        g.loadFromFile(path);
+        assert(g.loadStats().duplicateSegments == 3 && g.edgeCount() == 6);
+        auto edgeAt = [&](double lat) {
+            return g.findEdge(g.nodeId(Graph::coordinateKey(lat, -118.4400)), g.nodeId(Graph::coordinateKey(lat, -118.4390)));
+        };
+        const A scalars = g.edgeAttributes(edgeAt(34.0700));
+        assert(scalars.highway() == A::Highway::Footway && scalars.layer() == 1);
+        assert(scalars.incline() == A::Incline::Up && scalars.covered() && !scalars.bridge());
+        const Graph::EdgeId named = edgeAt(34.0710);
+        assert(g.edgeAttributes(named).highway() == A::Highway::Steps && g.edgeName(named) == "Janss Steps");
+        assert(g.edgeAttributes(edgeAt(34.0720)).highway() == A::Highway::Path);
+    }
+    std::filesystem::remove(path);
+
+    // Campus ways carry their tags
+    auto campus = Graph::fromFile("data/ucla.geojson");
+    std::size_t surfaced = 0, signalled = 0, named = 0;
+    for (Graph::EdgeId e = 0; e < campus->edgeCount(); ++e) {
+        const A a = campus->edgeAttributes(e);
+        assert(a.highway() != A::Highway::Unknown);
+        surfaced += a.surface() != A::Surface::Unknown;
+        signalled += a.crossing() == A::Crossing::Signals;
+        named += !campus->edgeName(e).empty();
+    }
+    assert(surfaced > campus->edgeCount() / 2 && signalled > 0 && named > 0);
+
+    // Contraction only merges segments that share tags, so every segment of a
+    // shaped edge reads the same as the full graph's edge
+    Graph::LoadOptions options;
+    options.contractChains = true;
+    auto contracted = Graph::fromFile("data/ucla.geojson", options);
+    for (Graph::NodeId v : contracted->nodes()) {
+        for (Graph::Neighbor edge : contracted->neighbors(v)) {
+            auto line = contracted->edgeGeometry(v, edge.edge);
+            for (std::size_t i = 0; i + 1 < line.size(); ++i) {
+                Graph::NodeId a = campus->nodeId(Graph::coordinateKey(line[i].lat, line[i].lon));
+                Graph::NodeId b = campus->nodeId(Graph::coordinateKey(line[i + 1].lat, line[i + 1].lon));
+                Graph::EdgeId segment = campus->findEdge(a, b);
+                assert(segment != Graph::kInvalidEdge);
+                assert(campus->edgeAttributes(segment) == contracted->edgeAttributes(edge.edge));
+                assert(campus->edgeName(segment) == contracted->edgeName(edge.edge));
+            }
+        }
+    }
+
+    // Attributes and names survive a snapshot round trip
+    const std::string snapshot = (std::filesystem::temp_directory_path() / "testAttributes.snapshot").string();
+    contracted->saveSnapshot(snapshot);
+    auto mapped = Graph::fromSnapshot(snapshot);
+    for (Graph::EdgeId e = 0; e < contracted->edgeCount(); ++e) {
+        assert(mapped->edgeAttributes(e) == contracted->edgeAttributes(e));
+        assert(mapped->edgeName(e) == contracted->edgeName(e));
+    }
+    std::filesystem::remove(snapshot);
+
+    std::cout << "PASS: testEdgeAttributes\n";
+}
+
 int main() {
     // These tests assume:
     // - Graph parses data/ucla.geojson into nodes + edges
@@ -128,6 +709,15 @@ int main() {
     testSameStartEnd();
     testInvalidNodeNames();
     testPathIsContinuousEdges();
+    testNeighborViewsMatchWrappers();
+    testExactNodeKeys();
+    testNodeOrders();
+    testComponents();
+    testChainContraction();
+    testMixedGeometries();
+    testCleanup();
+    testEdgeAttributes();
+    testSnapshotRoundTrip();
 
     std::cout << "ALL ROUTING TESTS PASSED\n";
     return 0;
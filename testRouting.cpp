@@ -3,30 +3,44 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <filesystem>
+#include <fstream>
+#include <thread>
 #include "CampusPathFinder/src/Dijkstra.h"
+#include "CampusPathFinder/src/Astar.h"
+#include "CampusPathFinder/src/BidirectionalDijkstra.h"
+#include "CampusPathFinder/src/BidirectionalAstar.h"
+#include "CampusPathFinder/src/ContractionHierarchy.h"
+#include "CampusPathFinder/src/AltAstar.h"
 #include "CampusPathFinder/src/Graph.h"
+#include "CampusPathFinder/src/GeoBatch.h"
+#include "CampusPathFinder/src/ThreadPool.h"
+#include "CampusPathFinder/src/DistanceMatrix.h"
+#include "CampusPathFinder/src/OneToAll.h"
+#include "CampusPathFinder/src/json.hpp"
 
 // Helper: pick two valid nodes from the loaded graph.
 static std::pair<std::string, std::string> pickTwoNodes(const Graph& g) {
-    auto list = g.getList();
-    assert(!list.empty());
-
-    std::string start, end;
+    assert(g.nodeCount() > 0);
 
     // start: first node that has at least 1 neighbor
-    for (const auto& kv : list) {
-        if (!kv.second.empty()) {
-            start = kv.first;
+    Graph::NodeId start = Graph::kInvalidNode;
+    for (Graph::NodeId u : g.nodes()) {
+        if (!g.neighbors(u).empty()) {
+            start = u;
             break;
         }
     }
-    assert(!start.empty());
+    assert(start != Graph::kInvalidNode);
 
-    // end: pick a neighbor of start (guarantees reachable in an undirected segment)
-    end = list[start].front().first;
-    assert(!end.empty());
+    // end: a neighbor of start (guarantees reachable in an undirected segment)
+    Graph::NodeId end = (*g.neighbors(start).begin()).to;
 
-    return {start, end};
+    return {g.nodeName(start), g.nodeName(end)};
 }
 
 static void testReachableSimple() {
@@ -57,12 +71,8 @@ static void testSameStartEnd() {
     g.loadFromFile("data/ucla.geojson");
 
     // pick any valid node
-    std::string node;
-    for (const auto& kv : g.getList()) {
-        node = kv.first;
-        break;
-    }
-    assert(!node.empty());
+    assert(g.nodeCount() > 0);
+    std::string node = g.nodeName(*g.nodes().begin());
 
     Dijkstra d("data/ucla.geojson");
     auto res = d.computePath(node, node);
@@ -120,6 +130,972 @@ static void testPathIsContinuousEdges() {
     std::cout << "PASS: testPathIsContinuousEdges\n";
 }
 
+static void testSharedGraph() {
+    auto graph = Graph::fromFile("data/ucla.geojson");
+
+    auto [start, end] = pickTwoNodes(*graph);
+
+    Dijkstra d(graph);
+    Astar a(graph);
+    assert(d.sharedGraph() == a.sharedGraph());
+
+    auto dres = d.computePath(start, end);
+    auto ares = a.computePath(start, end);
+
+    assert(dres.reachable && ares.reachable);
+    assert(dres.path.front() == start && dres.path.back() == end);
+    assert(std::abs(dres.weight - ares.weight) < 1e-6);
+
+    std::cout << "PASS: testSharedGraph\n";
+}
+
+// Every engine must agree with plain Dijkstra on reachability and distance.
+template <typename Engine>
+static void checkAgainstDijkstra(const std::shared_ptr<const Graph>& graph, Engine& engine,
+                                 const char* name, int trials = 300) {
+    Dijkstra reference(graph);
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<Graph::NodeId> pick(0, (Graph::NodeId)graph->nodeCount() - 1);
+
+    for (int i = 0; i < trials; ++i) {
+        std::string s = graph->nodeName(pick(rng));
+        std::string t = graph->nodeName(pick(rng));
+
+        auto expected = reference.computePath(s, t);
+        auto res = engine.computePath(s, t);
+
+        assert(res.reachable == expected.reachable);
+        if (!res.reachable) continue;
+
+        assert(std::abs(res.weight - expected.weight) < 1e-6 * std::max(1.0, expected.weight));
+        assert(res.path.front() == s && res.path.back() == t);
+
+        double walked = 0.0;
+        for (size_t k = 0; k + 1 < res.path.size(); ++k) {
+            double hop = std::numeric_limits<double>::infinity();
+            for (Graph::Neighbor edge : graph->neighbors(graph->nodeId(res.path[k]))) {
+                if (graph->nodeName(edge.to) == res.path[k + 1]) hop = std::min(hop, edge.weight);
+            }
+            assert(hop != std::numeric_limits<double>::infinity() && "Path contains a non-edge hop!");
+            walked += hop;
+        }
+        assert(std::abs(walked - res.weight) < 1e-6 * std::max(1.0, res.weight));
+    }
+
+    std::cout << "PASS: " << name << " matches Dijkstra\n";
+}
+
+static void testBidirectionalEngines() {
+    auto graph = Graph::fromFile("data/ucla.geojson");
+
+    BidirectionalDijkstra bd(graph);
+    checkAgainstDijkstra(graph, bd, "BidirectionalDijkstra");
+
+    BidirectionalAstar ba(graph);
+    checkAgainstDijkstra(graph, ba, "BidirectionalAstar");
+}
+
+static void testContractionHierarchy() {
+    auto graph = Graph::fromFile("data/ucla.geojson");
+
+    ContractionHierarchy ch(graph);
+    checkAgainstDijkstra(graph, ch, "ContractionHierarchy");
+
+    // A saved hierarchy reloads against the same graph and answers identically
+    const std::string path =
+        (std::filesystem::temp_directory_path() / "testRouting.ch").string();
+    ch.sharedHierarchy()->save(path, *graph);
+    ContractionHierarchy reloaded(graph, ContractionHierarchy::Hierarchy::load(path, *graph));
+    checkAgainstDijkstra(graph, reloaded, "ContractionHierarchy (reloaded)", 50);
+    std::filesystem::remove(path);
+
+    std::cout << "PASS: testContractionHierarchy\n";
+}
+
+// Push random keys (with repeats that exercise decrease-key) and expect sorted pops.
+template <typename Queue>
+static void checkQueueOrder() {
+    Queue queue;
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> key(0.0, 1000.0);
+    for (int round = 0; round < 3; ++round) {
+        queue.reset(500);
+        std::vector<double> best(500, std::numeric_limits<double>::infinity());
+        for (int i = 0; i < 2000; ++i) {
+            Graph::NodeId v = rng() % 500;
+            double k = key(rng);
+            queue.push({k, v});
+            best[v] = std::min(best[v], k);
+        }
+        double previous = -1.0;
+        std::size_t popped = 0;
+        while (!queue.empty()) {
+            auto [k, v] = queue.top();
+            queue.pop();
+            assert(k >= previous);
+            previous = k;
+            if (Queue::kDecreaseKey) assert(k == best[v]);
+            popped++;
+        }
+        assert(!Queue::kDecreaseKey || popped == (std::size_t)std::count_if(best.begin(), best.end(),
+            [](double d) { return d != std::numeric_limits<double>::infinity(); }));
+    }
+}
+
+static void testQueuePolicies() {
+    checkQueueOrder<BinaryHeapQueue>();
+    checkQueueOrder<QuaternaryHeapQueue>();
+    checkQueueOrder<PairingHeapQueue>();
+    checkQueueOrder<RadixHeapQueue>();
+
+    auto graph = Graph::fromFile("data/ucla.geojson");
+
+    BasicDijkstra<QuaternaryHeapQueue> quaternary(graph);
+    checkAgainstDijkstra(graph, quaternary, "Dijkstra (4-ary heap)", 100);
+    assert(quaternary.queueStats().stalePops == 0);
+    BasicDijkstra<RadixHeapQueue> radix(graph);
+    checkAgainstDijkstra(graph, radix, "Dijkstra (radix heap)", 100);
+    BasicDijkstra<PairingHeapQueue> pairing(graph);
+    checkAgainstDijkstra(graph, pairing, "Dijkstra (pairing heap)", 100);
+    assert(pairing.queueStats().stalePops == 0);
+
+    BasicAstar<QuaternaryHeapQueue> quaternaryAstar(graph);
+    checkAgainstDijkstra(graph, quaternaryAstar, "A* (4-ary heap)", 100);
+    BasicAstar<RadixHeapQueue> radixAstar(graph);
+    checkAgainstDijkstra(graph, radixAstar, "A* (radix heap)", 100);
+    BasicAstar<PairingHeapQueue> pairingAstar(graph);
+    checkAgainstDijkstra(graph, pairingAstar, "A* (pairing heap)", 100);
+
+    std::cout << "PASS: testQueuePolicies\n";
+}
+
+static void testAltAstar() {
+    auto graph = Graph::fromFile("data/ucla.geojson");
+
+    AltAstar avoid(graph);
+    assert(avoid.sharedLandmarks()->count() == AltAstar::kDefaultLandmarks);
+    checkAgainstDijkstra(graph, avoid, "AltAstar (avoid)");
+
+    AltAstar farthest(graph, AltAstar::selectLandmarks(*graph, 4, AltAstar::LandmarkSelection::Farthest));
+    checkAgainstDijkstra(graph, farthest, "AltAstar (farthest)");
+
+    // Landmarks are distinct nodes
+    auto nodes = avoid.sharedLandmarks()->nodes;
+    std::sort(nodes.begin(), nodes.end());
+    assert(std::adjacent_find(nodes.begin(), nodes.end()) == nodes.end());
+
+    std::cout << "PASS: testAltAstar\n";
+}
+
+// One const engine queried from several threads must answer exactly as it does sequentially.
+template <typename Engine>
+static void checkConcurrent(const std::shared_ptr<const Graph>& graph, const Engine& engine, const char* name) {
+    std::mt19937 rng(13);
+    std::uniform_int_distribution<Graph::NodeId> pick(0, (Graph::NodeId)graph->nodeCount() - 1);
+    std::vector<std::pair<std::string, std::string>> pairs;
+    for (int i = 0; i < 200; ++i) pairs.push_back({graph->nodeName(pick(rng)), graph->nodeName(pick(rng))});
+
+    std::vector<ShortestPathBase::PathResult> expected;
+    std::vector<bool> searched; // pairs in different components never reach a workspace
+    for (const auto& [s, t] : pairs) {
+        expected.push_back(engine.computePath(s, t));
+        searched.push_back(graph->connected(graph->nodeId(s), graph->nodeId(t)));
+    }
+
+    const int threadCount = 4;
+    std::vector<int> mismatches(threadCount, 0);
+    std::vector<std::size_t> answered(threadCount, 0);
+    std::vector<std::thread> threads;
+    for (int w = 0; w < threadCount; ++w) {
+        threads.emplace_back([&, w] {
+            for (std::size_t i = w; i < pairs.size(); i += threadCount / 2) { // overlapping slices
+                auto res = engine.computePath(pairs[i].first, pairs[i].second);
+                if (res.reachable != expected[i].reachable || res.path != expected[i].path ||
+                    res.weight != expected[i].weight) {
+                    mismatches[w]++;
+                }
+                if (searched[i]) answered[w]++;
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    for (int m : mismatches) assert(m == 0);
+    std::size_t total = std::count(searched.begin(), searched.end(), true);
+    for (std::size_t n : answered) total += n;
+    assert(engine.workspaceStats().queries == total);
+
+    std::cout << "PASS: " << name << " is consistent across threads\n";
+}
+
+static void testConcurrentQueries() {
+    auto graph = Graph::fromFile("data/ucla.geojson");
+
+    checkConcurrent(graph, Dijkstra(graph), "Dijkstra");
+    checkConcurrent(graph, BasicAstar<QuaternaryHeapQueue>(graph), "A* (4-ary heap)");
+    checkConcurrent(graph, BidirectionalAstar(graph), "BidirectionalAstar");
+    checkConcurrent(graph, ContractionHierarchy(graph), "ContractionHierarchy");
+    checkConcurrent(graph, AltAstar(graph), "AltAstar");
+
+    std::cout << "PASS: testConcurrentQueries\n";
+}
+
+static void testBatchQueries() {
+    auto graph = Graph::fromFile("data/ucla.geojson");
+    ContractionHierarchy ch(graph);
+    Dijkstra dijkstra(graph);
+
+    std::mt19937 rng(17);
+    std::uniform_int_distribution<Graph::NodeId> pick(0, (Graph::NodeId)graph->nodeCount() - 1);
+    std::vector<std::pair<Graph::NodeId, Graph::NodeId>> queries;
+    for (int i = 0; i < 500; ++i) queries.push_back({pick(rng), pick(rng)});
+    queries.push_back({Graph::kInvalidNode, 0}); // bad IDs come back unreachable, in place
+
+    ThreadPool pool(3);
+    auto results = ch.computePaths(queries, &pool);
+    assert(results.size() == queries.size());
+    for (std::size_t i = 0; i < queries.size(); ++i) {
+        auto expected = dijkstra.computePath(queries[i].first, queries[i].second);
+        assert(results[i].reachable == expected.reachable);
+        if (expected.reachable) {
+            assert(std::abs(results[i].weight - expected.weight) < 1e-6 * std::max(1.0, expected.weight));
+            assert(results[i].path.front() == graph->nodeName(queries[i].first));
+        }
+    }
+    assert(!results.back().reachable);
+
+    // Default pool, empty batch, and an exception thrown inside a task reaches the caller
+    assert(dijkstra.computePaths({}).empty());
+    bool caught = false;
+    try {
+        pool.parallelFor(100, [](std::size_t begin, std::size_t) {
+            if (begin == 0) throw std::runtime_error("task failed");
+        }, 10);
+    } catch (const std::runtime_error&) {
+        caught = true;
+    }
+    assert(caught);
+
+    std::cout << "PASS: testBatchQueries\n";
+}
+
+static void testDistanceMatrix() {
+    auto graph = Graph::fromFile("data/ucla.geojson");
+    DistanceMatrix matrix(graph);
+    Dijkstra dijkstra(graph);
+
+    std::mt19937 rng(19);
+    std::uniform_int_distribution<Graph::NodeId> pick(0, (Graph::NodeId)graph->nodeCount() - 1);
+    std::vector<Graph::NodeId> sources, targets;
+    for (int i = 0; i < 20; ++i) sources.push_back(pick(rng));
+    for (int i = 0; i < 30; ++i) targets.push_back(pick(rng));
+    targets.push_back(targets.front());   // repeated column
+    targets.push_back(sources.front());   // source that is also a target
+    targets.push_back(Graph::kInvalidNode);
+
+    auto table = matrix.compute(sources, targets);
+    assert(table.rows == sources.size() && table.cols == targets.size());
+    for (std::size_t r = 0; r < sources.size(); ++r) {
+        for (std::size_t c = 0; c + 1 < targets.size(); ++c) {
+            auto expected = dijkstra.computePath(sources[r], targets[c]);
+            if (!expected.reachable) {
+                assert(table.at(r, c) == std::numeric_limits<double>::infinity());
+            } else {
+                assert(std::abs(table.at(r, c) - expected.weight) < 1e-6 * std::max(1.0, expected.weight));
+            }
+        }
+        assert(table.at(r, targets.size() - 1) == std::numeric_limits<double>::infinity());
+    }
+    assert(table.at(0, targets.size() - 2) == 0.0);
+
+    // Parallel rows are identical to the sequential ones
+    ThreadPool pool(3);
+    auto parallel = matrix.compute(sources, targets, &pool);
+    assert(parallel.values == table.values);
+
+    std::cout << "PASS: testDistanceMatrix\n";
+}
+
+static void testOneToAll() {
+    auto graph = Graph::fromFile("data/ucla.geojson");
+    OneToAll oneToAll(graph);
+    Dijkstra dijkstra(graph);
+
+    auto [startName, endName] = pickTwoNodes(*graph);
+    Graph::NodeId source = graph->nodeId(startName);
+    auto tree = oneToAll.tree(source);
+    assert(tree.distance[source] == 0.0 && tree.reaches(source));
+
+    // Tree distances agree with point queries, and every parent edge is tight
+    std::mt19937 rng(29);
+    std::uniform_int_distribution<Graph::NodeId> pick(0, (Graph::NodeId)graph->nodeCount() - 1);
+    for (int i = 0; i < 100; ++i) {
+        Graph::NodeId v = pick(rng);
+        auto expected = dijkstra.computePath(source, v);
+        assert(tree.reaches(v) == expected.reachable);
+        if (!expected.reachable) continue;
+        assert(std::abs(tree.distance[v] - expected.weight) < 1e-6 * std::max(1.0, expected.weight));
+        auto path = tree.pathTo(v);
+        assert(path.front() == source && path.back() == v);
+    }
+    for (Graph::NodeId v : graph->nodes()) {
+        if (v == source || !tree.reaches(v)) continue;
+        double hop = std::numeric_limits<double>::infinity();
+        for (Graph::Neighbor edge : graph->neighbors(tree.parent[v])) {
+            if (edge.to == v) hop = std::min(hop, edge.weight);
+        }
+        assert(std::abs(tree.distance[tree.parent[v]] + hop - tree.distance[v]) < 1e-9 * std::max(1.0, tree.distance[v]));
+    }
+
+    // The isochrone is exactly the tree's nodes within the radius
+    const double radius = 400.0;
+    auto iso = oneToAll.isochrone(source, radius);
+    std::size_t within = 0;
+    for (Graph::NodeId v : graph->nodes()) within += tree.distance[v] <= radius;
+    assert(iso.nodes.size() == within);
+    for (std::size_t i = 0; i < iso.nodes.size(); ++i) {
+        assert(iso.distances[i] <= radius && iso.distances[i] == tree.distance[iso.nodes[i]]);
+        if (i > 0) assert(iso.distances[i - 1] <= iso.distances[i]);
+    }
+
+    auto walk = oneToAll.walkingIsochrone(source, 5.0);
+    assert(walk.radiusMeters == 5.0 * 60.0 * OneToAll::kWalkingSpeed);
+
+    auto geo = nlohmann::json::parse(iso.toGeoJson(*graph));
+    assert(geo["geometry"]["type"] == "MultiLineString");
+    assert(geo["properties"]["nodeCount"] == iso.nodes.size());
+    assert(!geo["geometry"]["coordinates"].empty());
+    for (const auto& line : geo["geometry"]["coordinates"]) assert(line.size() == 2 && line[0].size() == 2);
+
+    // A private way next to the source adds nothing to the isochrone, not even a zero-length stub
+    const std::string file = (std::filesystem::temp_directory_path() / "testIsochroneClosed.geojson").string();
+    {
+        std::ofstream out(file);
+        out << R"({"type": "FeatureCollection", "features": [
+            {"type": "Feature", "geometry": {"type": "LineString", "coordinates": [[-118.4400, 34.0700], [-118.4390, 34.0700]]}},
+            {"type": "Feature", "properties": {"access": "private"}, "geometry": {"type": "LineString",
+                "coordinates": [[-118.4400, 34.0700], [-118.4400, 34.0710]]}}
+        ]})";
+    }
+    auto closed = Graph::fromFile(file);
+    std::filesystem::remove(file);
+    auto closedIso = OneToAll(closed).isochrone(closed->nodeId(Graph::coordinateKey(34.0700, -118.4400)), 50.0);
+    assert(closedIso.nodes.size() == 1);
+    auto closedGeo = nlohmann::json::parse(closedIso.toGeoJson(*closed));
+    assert(closedGeo["geometry"]["coordinates"].size() == 1);
+    for (const auto& line : closedGeo["geometry"]["coordinates"]) assert(line[0] != line[line.size() - 1]);
+
+    std::cout << "PASS: testOneToAll\n";
+}
+
+// Local flat-earth meters around the query, the same approximation the index uses
+static double flatMeters(double lat1, double lon1, double lat2, double lon2) {
+    const double k = 6371000.0 * M_PI / 180.0;
+    double dx = (lon2 - lon1) * k * std::cos(lat1 * M_PI / 180.0);
+    double dy = (lat2 - lat1) * k;
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+static void testSpatialIndex() {
+    auto graph = Graph::fromFile("data/ucla.geojson");
+    Dijkstra dijkstra(graph);
+
+    double minLat = 90, maxLat = -90, minLon = 180, maxLon = -180;
+    for (Graph::NodeId v : graph->nodes()) {
+        minLat = std::min(minLat, graph->location(v).lat);
+        maxLat = std::max(maxLat, graph->location(v).lat);
+        minLon = std::min(minLon, graph->location(v).lon);
+        maxLon = std::max(maxLon, graph->location(v).lon);
+    }
+
+    // Every node snaps to itself
+    for (Graph::NodeId v = 0; v < graph->nodeCount(); v += 97) {
+        assert(graph->nearestNode(graph->location(v).lat, graph->location(v).lon) == v);
+    }
+
+    // Random points, some well outside the map, agree with a brute-force scan
+    std::mt19937 rng(31);
+    std::uniform_real_distribution<double> lat(minLat - 0.01, maxLat + 0.01);
+    std::uniform_real_distribution<double> lon(minLon - 0.01, maxLon + 0.01);
+    for (int i = 0; i < 200; ++i) {
+        double qLat = lat(rng), qLon = lon(rng);
+
+        double bestNode = std::numeric_limits<double>::infinity();
+        for (Graph::NodeId v : graph->nodes()) {
+            bestNode = std::min(bestNode, flatMeters(qLat, qLon, graph->location(v).lat, graph->location(v).lon));
+        }
+        Graph::NodeId snapped = graph->nearestNode(qLat, qLon);
+        assert(snapped != Graph::kInvalidNode);
+        double got = flatMeters(qLat, qLon, graph->location(snapped).lat, graph->location(snapped).lon);
+        assert(got <= bestNode * 1.001 + 0.01);
+
+        double bestEdge = std::numeric_limits<double>::infinity();
+        for (Graph::NodeId u : graph->nodes()) {
+            for (Graph::Neighbor edge : graph->neighbors(u)) {
+                auto a = graph->location(u), b = graph->location(edge.to);
+                for (int step = 0; step <= 64; ++step) {
+                    double t = step / 64.0;
+                    bestEdge = std::min(bestEdge, flatMeters(qLat, qLon, a.lat + (b.lat - a.lat) * t, a.lon + (b.lon - a.lon) * t));
+                }
+            }
+        }
+        auto point = graph->nearestEdgePoint(qLat, qLon);
+        assert(point.edge < graph->edgeCount());
+        assert(point.fraction >= 0.0 && point.fraction <= 1.0);
+        assert(point.from < graph->nodeCount() && graph->edgeBegin(point.from) <= point.edge && point.edge < graph->edgeEnd(point.from));
+        assert(point.distance <= bestNode * 1.001 + 0.01);
+        assert(point.distance <= bestEdge * 1.001 + 0.01);
+        assert(std::abs(flatMeters(qLat, qLon, point.lat, point.lon) - point.distance) < 0.01 * std::max(1.0, point.distance));
+    }
+
+    // Points far off the map still prune their ring search and find the true nearest node
+    const double midLat = (minLat + maxLat) / 2, midLon = (minLon + maxLon) / 2;
+    for (auto [qLat, qLon] : {std::pair{maxLat + 0.5, midLon}, std::pair{minLat - 0.5, minLon - 0.5},
+                              std::pair{midLat, maxLon + 0.5}, std::pair{maxLat + 0.02, maxLon + 0.3}}) {
+        double bestNode = std::numeric_limits<double>::infinity();
+        for (Graph::NodeId v : graph->nodes()) {
+            bestNode = std::min(bestNode, flatMeters(qLat, qLon, graph->location(v).lat, graph->location(v).lon));
+        }
+        Graph::NodeId snapped = graph->nearestNode(qLat, qLon);
+        assert(flatMeters(qLat, qLon, graph->location(snapped).lat, graph->location(snapped).lon) <= bestNode * 1.001 + 0.01);
+        auto point = graph->nearestEdgePoint(qLat, qLon);
+        assert(graph->isValid(point) && point.distance <= bestNode * 1.001 + 0.01);
+    }
+
+    // Coordinates next to nodes route (via snapped edge points) like the nodes themselves
+    auto [startName, endName] = pickTwoNodes(*graph);
+    Graph::NodeId s = graph->nodeId(startName), t = graph->nodeId(endName);
+    Graph::Coordinate nearS{graph->location(s).lat + 1e-7, graph->location(s).lon};
+    Graph::Coordinate nearT{graph->location(t).lat, graph->location(t).lon - 1e-7};
+    auto byCoordinate = dijkstra.computePath(nearS, nearT);
+    auto byId = dijkstra.computePath(s, t);
+    assert(byCoordinate.reachable && byId.reachable);
+    assert(std::abs(byCoordinate.weight - byId.weight) < 0.1);
+
+    std::cout << "PASS: testSpatialIndex\n";
+}
+
+// Brute force: best of the four endpoint-to-endpoint routes plus partials, or straight along a shared edge
+static double edgePointDistance(const Graph& graph, Dijkstra& dijkstra, const Graph::EdgePoint& a, const Graph::EdgePoint& b) {
+    Graph::NodeId aEnds[2] = {a.from, graph.edgeTarget(a.edge)};
+    Graph::NodeId bEnds[2] = {b.from, graph.edgeTarget(b.edge)};
+    double aPartial[2] = {a.fraction * graph.edgeWeight(a.edge), (1 - a.fraction) * graph.edgeWeight(a.edge)};
+    double bPartial[2] = {b.fraction * graph.edgeWeight(b.edge), (1 - b.fraction) * graph.edgeWeight(b.edge)};
+    double best = std::numeric_limits<double>::infinity();
+    if (a.edge == b.edge) best = std::abs(a.fraction - b.fraction) * graph.edgeWeight(a.edge);
+    if (b.edge == graph.reverseEdge(a.from, a.edge)) best = std::abs(a.fraction - (1 - b.fraction)) * graph.edgeWeight(a.edge);
+    for (int i = 0; i < 2; ++i) {
+        for (int j = 0; j < 2; ++j) {
+            auto res = dijkstra.computePath(aEnds[i], bEnds[j]);
+            if (res.reachable) best = std::min(best, aPartial[i] + res.weight + bPartial[j]);
+        }
+    }
+    return best;
+}
+
+static void testEdgePointQueries() {
+    auto graph = Graph::fromFile("data/ucla.geojson");
+    Dijkstra dijkstra(graph);
+    ContractionHierarchy ch(graph);
+    AltAstar alt(graph);
+
+    auto pointAt = [&](Graph::NodeId from, Graph::EdgeId edge, double fraction) {
+        auto at = graph->edgeGeometry(from, edge, fraction, fraction).front();
+        return Graph::EdgePoint{edge, from, fraction, at.lat, at.lon, 0.0};
+    };
+    auto close = [](const Graph::Coordinate& a, double lat, double lon) {
+        return std::abs(a.lat - lat) < 1e-9 && std::abs(a.lon - lon) < 1e-9;
+    };
+
+    std::mt19937 rng(41);
+    std::uniform_int_distribution<Graph::NodeId> pickNode(0, (Graph::NodeId)graph->nodeCount() - 1);
+    std::uniform_real_distribution<double> pickFraction(0.0, 1.0);
+    auto randomPoint = [&]() {
+        Graph::NodeId u;
+        do { u = pickNode(rng); } while (graph->neighbors(u).empty());
+        std::uniform_int_distribution<Graph::EdgeId> pickEdge(graph->edgeBegin(u), graph->edgeEnd(u) - 1);
+        return pointAt(u, pickEdge(rng), pickFraction(rng));
+    };
+
+    int reachable = 0;
+    for (int i = 0; i < 60; ++i) {
+        auto a = randomPoint(), b = randomPoint();
+        double expected = edgePointDistance(*graph, dijkstra, a, b);
+        auto res = dijkstra.computePath(a, b);
+        assert(res.reachable == (expected != std::numeric_limits<double>::infinity()));
+        if (!res.reachable) continue;
+        reachable++;
+        assert(std::abs(res.weight - expected) < 1e-6 * std::max(1.0, expected));
+        // Same answer from the engines that route through the edge ends with their own search
+        const ShortestPathBase* viaEnds[] = {&ch, &alt};
+        for (const ShortestPathBase* engine : viaEnds) {
+            auto other = engine->computePath(a, b);
+            assert(other.reachable && std::abs(other.weight - res.weight) < 1e-6 * std::max(1.0, expected));
+            assert(close(other.geometry.front(), a.lat, a.lon) && close(other.geometry.back(), b.lat, b.lon));
+            assert(other.geometry.size() == other.path.size() + 2);
+        }
+
+        // Geometry runs from point to point through every node of the path
+        assert(res.geometry.size() == res.path.size() + 2);
+        assert(close(res.geometry.front(), a.lat, a.lon) && close(res.geometry.back(), b.lat, b.lon));
+        for (std::size_t k = 0; k < res.path.size(); ++k) {
+            auto at = graph->location(graph->nodeId(res.path[k]));
+            assert(close(res.geometry[k + 1], at.lat, at.lon));
+        }
+    }
+    assert(reachable > 0);
+
+    // Two points on one edge, given in opposite directions, walk straight along it
+    Graph::NodeId u = graph->nodeId(pickTwoNodes(*graph).first);
+    Graph::EdgeId e = graph->edgeBegin(u);
+    Graph::NodeId v = graph->edgeTarget(e);
+    Graph::EdgeId back = graph->edgeBegin(v);
+    while (graph->edgeTarget(back) != u) back++;
+    auto along = dijkstra.computePath(pointAt(u, e, 0.2), pointAt(v, back, 0.3));
+    assert(along.reachable && along.path.empty() && along.geometry.size() == 2);
+    assert(std::abs(along.weight - 0.5 * graph->edgeWeight(e)) < 1e-9);
+    auto alongCh = ch.computePath(pointAt(u, e, 0.2), pointAt(v, back, 0.3));
+    assert(alongCh.reachable && alongCh.path.empty() && alongCh.weight == along.weight);
+
+    // Malformed points are rejected, not searched
+    auto bad = pointAt(u, e, 0.5);
+    bad.edge = graph->edgeEnd(u);
+    assert(!dijkstra.computePath(bad, pointAt(u, e, 0.5)).reachable);
+
+    std::cout << "PASS: testEdgePointQueries\n";
+}
+
+// A straight segment and a contracted detour both join A and B; points on
+// different ones must not be treated as sharing an edge
+static void testParallelEdgePoints() {
+    const std::string path = (std::filesystem::temp_directory_path() / "testParallel.geojson").string();
+    {
+        std::ofstream out(path);
+        out << R"({"type": "FeatureCollection", "features": [
+            {"type": "Feature", "geometry": {"type": "LineString", "coordinates": [[-118.4400, 34.0700], [-118.4390, 34.0700]]}},
+            {"type": "Feature", "geometry": {"type": "LineString", "coordinates":
+                [[-118.4400, 34.0700], [-118.4395, 34.0712], [-118.4390, 34.0700]]}},
+            {"type": "Feature", "geometry": {"type": "LineString", "coordinates": [[-118.4400, 34.0700], [-118.4410, 34.0700]]}},
+            {"type": "Feature", "geometry": {"type": "LineString", "coordinates": [[-118.4390, 34.0700], [-118.4380, 34.0700]]}}
+        ]})";
+    }
+    Graph::LoadOptions options;
+    options.contractChains = true;
+    auto graph = Graph::fromFile(path, options);
+    std::filesystem::remove(path);
+    assert(graph->nodeCount() == 4);
+
+    const Graph::NodeId a = graph->nodeId(Graph::coordinateKey(34.0700, -118.4400));
+    const Graph::NodeId b = graph->nodeId(Graph::coordinateKey(34.0700, -118.4390));
+    Graph::EdgeId shortEdge = Graph::kInvalidEdge, longEdge = Graph::kInvalidEdge;
+    for (Graph::Neighbor edge : graph->neighbors(a)) {
+        if (edge.to != b) continue;
+        (graph->edgePointCount(edge.edge) == 2 ? shortEdge : longEdge) = edge.edge;
+    }
+    assert(shortEdge != Graph::kInvalidEdge && longEdge != Graph::kInvalidEdge);
+    assert(graph->reverseEdge(a, shortEdge) != graph->reverseEdge(a, longEdge));
+    assert(graph->edgePointCount(graph->reverseEdge(a, longEdge)) == 3);
+    const double shortWeight = graph->edgeWeight(shortEdge), longWeight = graph->edgeWeight(longEdge);
+
+    Dijkstra dijkstra(graph);
+    auto pointAt = [&](Graph::NodeId from, Graph::EdgeId edge, double fraction) {
+        auto at = graph->edgeGeometry(from, edge, fraction, fraction).front();
+        return Graph::EdgePoint{edge, from, fraction, at.lat, at.lon, 0.0};
+    };
+    // Half the detour to B, then back along 45% of the straight segment
+    auto across = dijkstra.computePath(pointAt(a, longEdge, 0.5), pointAt(a, shortEdge, 0.55));
+    assert(across.reachable && across.path.size() == 1);
+    assert(std::abs(across.weight - (0.5 * longWeight + 0.45 * shortWeight)) < 1e-9);
+    assert(std::abs(across.weight - edgePointDistance(*graph, dijkstra, pointAt(a, longEdge, 0.5),
+                                                      pointAt(a, shortEdge, 0.55))) < 1e-9);
+
+    // The reverse twin of the detour is still the same edge
+    auto along = dijkstra.computePath(pointAt(a, longEdge, 0.2), pointAt(b, graph->reverseEdge(a, longEdge), 0.3));
+    assert(along.reachable && along.path.empty());
+    assert(std::abs(along.weight - 0.5 * longWeight) < 1e-9);
+
+    std::cout << "PASS: testParallelEdgePoints\n";
+}
+
+static void testAstarHeuristics() {
+    auto graph = Graph::fromFile("data/ucla.geojson");
+    Dijkstra dijkstra(graph);
+
+    // chord <= great circle == haversine <= true walking distance
+    std::mt19937 rng(43);
+    std::uniform_int_distribution<Graph::NodeId> pick(0, (Graph::NodeId)graph->nodeCount() - 1);
+    for (int i = 0; i < 200; ++i) {
+        Graph::NodeId u = pick(rng), v = pick(rng);
+        const auto& a = graph->location(u);
+        const auto& b = graph->location(v);
+        double arc = Geo::greatCircle(graph->geoPoint(u), graph->geoPoint(v));
+        double chord = Geo::chord(graph->geoPoint(u), graph->geoPoint(v));
+        assert(std::abs(arc - Geo::haversine(a.lat, a.lon, b.lat, b.lon)) < 1e-6);
+        assert(chord <= arc + 1e-9);
+        auto walk = dijkstra.computePath(u, v);
+        if (walk.reachable) assert(arc <= walk.weight + 1e-6);
+    }
+
+    // Consistency along every edge: the estimate drops by at most the edge weight
+    Graph::NodeId goal = pick(rng);
+    for (Graph::NodeId u : graph->nodes()) {
+        for (Graph::Neighbor edge : graph->neighbors(u)) {
+            double hu = Geo::chord(graph->geoPoint(u), graph->geoPoint(goal));
+            double hv = Geo::chord(graph->geoPoint(edge.to), graph->geoPoint(goal));
+            assert(hu <= edge.weight + hv + 1e-6);
+        }
+    }
+
+    Astar chordAstar(graph, AstarHeuristic::Chord);
+    checkAgainstDijkstra(graph, chordAstar, "Astar (chord)");
+    Astar arcAstar(graph, AstarHeuristic::GreatCircle);
+    checkAgainstDijkstra(graph, arcAstar, "Astar (great circle)");
+}
+
+static void testGeoBatchKernels() {
+    auto graph = Graph::fromFile("data/ucla.geojson");
+    auto points = graph->geoPoints();
+
+    // Every node against one target; 1003 leaves a ragged tail for the vector loops
+    std::vector<std::uint32_t> ids(1003);
+    for (std::size_t i = 0; i < ids.size(); ++i) ids[i] = (std::uint32_t)((i * 7919) % graph->nodeCount());
+    const Geo::Point& target = graph->geoPoint(ids[5]);
+
+    // Long segments (past the asin series) on a synthetic set of points around the globe
+    std::vector<Geo::Point> globe;
+    for (double lat = -80; lat <= 80; lat += 20) {
+        for (double lon = -170; lon <= 170; lon += 37) globe.push_back(Geo::toPoint(lat, lon));
+    }
+    std::vector<std::uint32_t> from, to;
+    for (std::uint32_t i = 0; i < globe.size(); ++i) {
+        from.push_back(i);
+        to.push_back((i * 13 + 5) % globe.size());
+    }
+
+    for (auto kernel : {GeoBatch::Kernel::Scalar, GeoBatch::Kernel::Avx2, GeoBatch::Kernel::Avx512}) {
+        std::vector<double> out(ids.size());
+        GeoBatch::chordDistances(points.data(), ids.data(), ids.size(), target, out.data(), kernel);
+        for (std::size_t i = 0; i < ids.size(); ++i) {
+            assert(std::abs(out[i] - Geo::chord(points[ids[i]], target)) < 1e-6);
+        }
+
+        std::vector<double> arcs(globe.size());
+        GeoBatch::arcDistances(globe.data(), from.data(), to.data(), globe.size(), arcs.data(), kernel);
+        for (std::size_t i = 0; i < globe.size(); ++i) {
+            assert(std::abs(arcs[i] - Geo::greatCircle(globe[from[i]], globe[to[i]])) < 1e-3);
+        }
+    }
+
+    // Ingestion weights (from the batch kernel) are the haversine segment lengths
+    for (Graph::NodeId u : graph->nodes()) {
+        for (Graph::Neighbor edge : graph->neighbors(u)) {
+            const auto& a = graph->location(u);
+            const auto& b = graph->location(edge.to);
+            assert(std::abs(edge.weight - Geo::haversine(a.lat, a.lon, b.lat, b.lon)) < 1e-6);
+        }
+    }
+
+    std::cout << "PASS: testGeoBatchKernels (best: " << GeoBatch::name(GeoBatch::bestKernel()) << ")\n";
+}
+
+// Pairs in different components come back unreachable without searching
+template <typename Engine>
+static void checkRejectsAcrossComponents(const std::shared_ptr<const Graph>& graph, const Engine& engine,
+                                         Graph::NodeId inside, Graph::NodeId outside, const char* name) {
+    auto res = engine.computePath(inside, outside);
+    assert(!res.reachable && res.path.empty());
+    assert(res.settledNodes == 0 && res.touchedNodes == 0);
+    assert(res.elapsedMs >= 0.0);
+    assert(engine.workspaceStats().queries == 0);
+
+    // Same-component pairs still search as before
+    auto ok = engine.computePath(inside, (*graph->neighbors(inside).begin()).to);
+    assert(ok.reachable);
+
+    std::cout << "PASS: " << name << " rejects cross-component pairs\n";
+}
+
+static void testComponentRejection() {
+    auto graph = Graph::fromFile("data/ucla.geojson");
+    if (graph->componentCount() < 2) {
+        std::cout << "SKIP: testComponentRejection (graph is connected)\n";
+        return;
+    }
+
+    Graph::NodeId inside = Graph::kInvalidNode;
+    Graph::NodeId outside = Graph::kInvalidNode;
+    for (Graph::NodeId u : graph->nodes()) {
+        bool big = graph->componentOf(u) == graph->largestComponent();
+        if (big && inside == Graph::kInvalidNode && !graph->neighbors(u).empty()) inside = u;
+        if (!big && outside == Graph::kInvalidNode) outside = u;
+    }
+    assert(inside != Graph::kInvalidNode && outside != Graph::kInvalidNode);
+    assert(!graph->connected(inside, outside));
+
+    // A Dijkstra that ignored the labels could only confirm this by exhausting the component
+    auto plain = Dijkstra(graph).computePath(inside, outside);
+    assert(!plain.reachable);
+
+    checkRejectsAcrossComponents(graph, Dijkstra(graph), inside, outside, "Dijkstra");
+    checkRejectsAcrossComponents(graph, Astar(graph), inside, outside, "Astar");
+    checkRejectsAcrossComponents(graph, BidirectionalDijkstra(graph), inside, outside, "BidirectionalDijkstra");
+    checkRejectsAcrossComponents(graph, BidirectionalAstar(graph), inside, outside, "BidirectionalAstar");
+    checkRejectsAcrossComponents(graph, AltAstar(graph), inside, outside, "AltAstar");
+    checkRejectsAcrossComponents(graph, ContractionHierarchy(graph), inside, outside, "ContractionHierarchy");
+
+    // Matrix rows whose targets all sit in other components are skipped, not searched
+    std::vector<Graph::NodeId> sources{inside, outside};
+    std::vector<Graph::NodeId> targets{outside};
+    DistanceMatrix matrix(graph);
+    auto m = matrix.compute(sources, targets);
+    assert(std::isinf(m.at(0, 0)));
+    assert(m.at(1, 0) == 0.0);
+    assert(m.settledNodes <= graph->componentSize(graph->componentOf(outside)));
+
+    std::cout << "PASS: testComponentRejection\n";
+}
+
+// Engines on a chain-contracted graph agree with Dijkstra on the full one
+static void testContractedChains() {
+    auto full = Graph::fromFile("data/ucla.geojson");
+    Graph::LoadOptions options;
+    options.contractChains = true;
+    auto contracted = Graph::fromFile("data/ucla.geojson", options);
+    Dijkstra reference(full);
+
+    Dijkstra dijkstra(contracted);
+    Astar astar(contracted);
+    BidirectionalAstar bidirectional(contracted);
+    ContractionHierarchy ch(contracted);
+    AltAstar alt(contracted);
+    const ShortestPathBase* engines[] = {&dijkstra, &astar, &bidirectional, &ch, &alt};
+
+    std::mt19937 rng(53);
+    std::uniform_int_distribution<Graph::NodeId> pick(0, (Graph::NodeId)contracted->nodeCount() - 1);
+    for (int i = 0; i < 100; ++i) {
+        Graph::NodeId s = pick(rng), t = pick(rng);
+        auto expected = reference.computePath(contracted->nodeName(s), contracted->nodeName(t));
+        for (const ShortestPathBase* engine : engines) {
+            auto res = engine->computePath(s, t);
+            assert(res.reachable == expected.reachable);
+            if (res.reachable) assert(std::abs(res.weight - expected.weight) < 1e-6 * std::max(1.0, expected.weight));
+        }
+    }
+
+    // Arbitrary coordinates snap onto the shape of contracted edges and route the same
+    Dijkstra fullDijkstra(full);
+    std::uniform_int_distribution<Graph::NodeId> pickFull(0, (Graph::NodeId)full->nodeCount() - 1);
+    std::uniform_real_distribution<double> jitter(-2e-5, 2e-5);
+    int reachable = 0;
+    for (int i = 0; i < 60; ++i) {
+        auto a = full->location(pickFull(rng)), b = full->location(pickFull(rng));
+        Graph::Coordinate from{a.lat + jitter(rng), a.lon + jitter(rng)};
+        Graph::Coordinate to{b.lat + jitter(rng), b.lon + jitter(rng)};
+        auto expected = fullDijkstra.computePath(from, to);
+        auto res = dijkstra.computePath(from, to);
+        assert(res.reachable == expected.reachable);
+        if (!res.reachable) continue;
+        reachable++;
+        assert(std::abs(res.weight - expected.weight) < 1e-3);
+        assert(std::abs(res.geometry.front().lat - expected.geometry.front().lat) < 1e-9);
+        assert(std::abs(res.geometry.back().lon - expected.geometry.back().lon) < 1e-9);
+        double traced = 0.0;
+        for (std::size_t k = 1; k < res.geometry.size(); ++k) {
+            traced += Geo::haversine(res.geometry[k - 1].lat, res.geometry[k - 1].lon, res.geometry[k].lat, res.geometry[k].lon);
+        }
+        assert(std::abs(traced - res.weight) < 1e-3);
+    }
+    assert(reachable > 0);
+
+    std::cout << "PASS: testContractedChains\n";
+}
+
+// Every engine routes each profile by that profile's costs, and agrees with plain Dijkstra on them
+template <typename Engine>
+static void checkProfile(const Graph& graph, const Engine& engine, Graph::Profile profile, const char* name) {
+    Dijkstra reference(engine.sharedGraph());
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<Graph::NodeId> pick(0, (Graph::NodeId)graph.nodeCount() - 1);
+    for (int i = 0; i < 150; ++i) {
+        Graph::NodeId s = pick(rng), t = pick(rng);
+        auto expected = reference.computePath(s, t, profile);
+        auto res = engine.computePath(s, t, profile);
+        assert(res.reachable == expected.reachable);
+        if (!res.reachable) continue;
+        assert(std::abs(res.weight - expected.weight) < 1e-6 * std::max(1.0, expected.weight));
+        assert(res.weight >= reference.computePath(s, t).weight - 1e-6);
+
+        double cost = 0.0;
+        for (size_t k = 0; k + 1 < res.path.size(); ++k) {
+            Graph::EdgeId e = graph.findEdge(graph.nodeId(res.path[k]), graph.nodeId(res.path[k + 1]), profile);
+            assert(e != Graph::kInvalidEdge && std::isfinite(graph.edgeWeight(e, profile)));
+            cost += graph.edgeWeight(e, profile);
+        }
+        assert(std::abs(cost - res.weight) < 1e-6 * std::max(1.0, res.weight));
+    }
+    std::cout << "PASS: " << name << " (" << RoutingProfile::name(profile) << ") matches Dijkstra\n";
+}
+
+static void testRoutingProfiles() {
+    using Profile = Graph::Profile;
+    auto graph = Graph::fromFile("data/ucla.geojson");
+    const Profile profiles[] = {Profile::Walking, Profile::Wheelchair, Profile::Bicycle, Profile::Night, Profile::Rain};
+
+    // Walking is the plain length but for private ways, which no profile uses; the
+    // other profiles never undercut it and cost the same both ways
+    std::size_t closedToAll = 0, closedToWheelchairs = 0, dearerAtNight = 0;
+    for (Graph::NodeId u : graph->nodes()) {
+        for (Graph::Neighbor edge : graph->neighbors(u)) {
+            const auto access = graph->edgeAttributes(edge.edge).access();
+            const bool closed = access == EdgeAttributes::Access::Private || access == EdgeAttributes::Access::No;
+            assert(graph->edgeWeight(edge.edge, Profile::Walking) == (closed ? std::numeric_limits<double>::infinity() : edge.weight));
+            closedToAll += closed;
+            Graph::EdgeId back = graph->findEdge(edge.to, u);
+            for (Profile profile : profiles) {
+                assert(graph->edgeWeight(edge.edge, profile) >= edge.weight);
+                assert(graph->edgeWeight(edge.edge, profile) == graph->edgeWeight(back, profile));
+            }
+            closedToWheelchairs += std::isinf(graph->edgeWeight(edge.edge, Profile::Wheelchair));
+            dearerAtNight += graph->edgeWeight(edge.edge, Profile::Night) > edge.weight;
+        }
+    }
+    assert(closedToAll > 0 && closedToWheelchairs > closedToAll && dearerAtNight > 0);
+
+    // A wheelchair pays for a slope by its steepness, either way, and cannot take one over 8%
+    auto ramp = [](const char* incline) {
+        EdgeAttributes a;
+        a.applyTag("incline", incline);
+        return RoutingProfile::factor(Profile::Wheelchair, a);
+    };
+    assert(ramp("0.5%") < ramp("4%") && ramp("4%") < ramp("7%") && ramp("-0.5%") == ramp("0.5%"));
+    assert(std::isinf(ramp("12%")) && std::isinf(ramp("-9%")) && std::isfinite(ramp("up")));
+
+    // One engine per algorithm serves every profile
+    Astar astar(graph);
+    BidirectionalDijkstra bd(graph);
+    BidirectionalAstar ba(graph);
+    AltAstar alt(graph);
+    for (Profile profile : profiles) {
+        checkProfile(*graph, astar, profile, "Astar");
+        checkProfile(*graph, bd, profile, "BidirectionalDijkstra");
+        checkProfile(*graph, ba, profile, "BidirectionalAstar");
+        checkProfile(*graph, alt, profile, "AltAstar");
+    }
+
+    // A hierarchy answers only the profile it was contracted for, and survives a reload
+    ContractionHierarchy night(graph, Profile::Night);
+    checkProfile(*graph, night, Profile::Night, "ContractionHierarchy");
+    bool threw = false;
+    try {
+        night.computePath(0, 1);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+    // Coordinate queries go through the hierarchy too, so they are held to its profile
+    threw = false;
+    try {
+        night.computePath(graph->location(0), graph->location(1));
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+    const std::string path = (std::filesystem::temp_directory_path() / "testProfiles.ch").string();
+    night.sharedHierarchy()->save(path, *graph);
+    auto reloaded = ContractionHierarchy::Hierarchy::load(path, *graph);
+    assert(reloaded->profile == Profile::Night);
+    checkProfile(*graph, ContractionHierarchy(graph, reloaded), Profile::Night, "ContractionHierarchy (reloaded)");
+    std::filesystem::remove(path);
+
+    // A route that crosses an edge closed to wheelchairs detours or gives up
+    Dijkstra dijkstra(graph);
+    for (Graph::NodeId u : graph->nodes()) {
+        for (Graph::Neighbor edge : graph->neighbors(u)) {
+            if (!std::isinf(graph->edgeWeight(edge.edge, Profile::Wheelchair))) continue;
+            if (std::isinf(graph->edgeWeight(edge.edge, Profile::Walking))) continue; // private
+            auto walking = dijkstra.computePath(u, edge.to);
+            auto rolling = dijkstra.computePath(u, edge.to, Profile::Wheelchair);
+            assert(walking.reachable && walking.path.size() == 2);
+            assert(!rolling.reachable || rolling.path.size() > 2);
+        }
+    }
+
+    // Edge points and batches carry the profile through
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<Graph::NodeId> pick(0, (Graph::NodeId)graph->nodeCount() - 1);
+    std::vector<std::pair<Graph::NodeId, Graph::NodeId>> queries;
+    for (int i = 0; i < 100; ++i) queries.push_back({pick(rng), pick(rng)});
+    auto batch = dijkstra.computePaths(queries, nullptr, Profile::Rain);
+    for (std::size_t i = 0; i < queries.size(); ++i) {
+        auto single = dijkstra.computePath(queries[i].first, queries[i].second, Profile::Rain);
+        assert(batch[i].reachable == single.reachable && batch[i].weight == single.weight);
+
+        const Graph::NodeId s = queries[i].first, t = queries[i].second;
+        if (graph->neighbors(s).empty() || graph->neighbors(t).empty() || s == t) continue;
+        Graph::EdgePoint a{graph->edgeBegin(s), s, 0.0};
+        Graph::EdgePoint b{graph->edgeBegin(t), t, 0.0};
+        auto viaPoints = dijkstra.computePath(a, b, Profile::Rain);
+        assert(viaPoints.reachable == single.reachable);
+        if (single.reachable) assert(std::abs(viaPoints.weight - single.weight) < 1e-6 * std::max(1.0, single.weight));
+    }
+
+    // Between parallel edges the profile decides which one the path (and its geometry) uses:
+    // at night the lit detour beats the shorter unlit segment
+    const std::string file = (std::filesystem::temp_directory_path() / "testProfileChains.geojson").string();
+    {
+        std::ofstream out(file);
+        out << R"({"type": "FeatureCollection", "features": [
+            {"type": "Feature", "properties": {"lit": "no"}, "geometry": {"type": "LineString",
+                "coordinates": [[-118.4400, 34.0700], [-118.4390, 34.0700]]}},
+            {"type": "Feature", "properties": {"lit": "yes"}, "geometry": {"type": "LineString",
+                "coordinates": [[-118.4400, 34.0700], [-118.4395, 34.0705], [-118.4390, 34.0700]]}},
+            {"type": "Feature", "geometry": {"type": "LineString", "coordinates": [[-118.4400, 34.0700], [-118.4410, 34.0700]]}},
+            {"type": "Feature", "geometry": {"type": "LineString", "coordinates": [[-118.4390, 34.0700], [-118.4380, 34.0700]]}}
+        ]})";
+    }
+    Graph::LoadOptions options;
+    options.contractChains = true;
+    auto chains = Graph::fromFile(file, options);
+    std::filesystem::remove(file);
+    const Graph::NodeId a = chains->nodeId(Graph::coordinateKey(34.0700, -118.4400));
+    const Graph::NodeId b = chains->nodeId(Graph::coordinateKey(34.0700, -118.4390));
+    Dijkstra chainDijkstra(chains);
+    auto byDay = chainDijkstra.computePath(a, b);
+    auto byNight = chainDijkstra.computePath(a, b, Profile::Night);
+    assert(chains->edgePointCount(chains->findEdge(a, b)) == 2);
+    assert(chains->edgePointCount(chains->findEdge(a, b, Profile::Night)) == 3);
+    assert(chains->pathGeometry(byDay.path).size() == 2);
+    assert(chains->pathGeometry(byNight.path, Profile::Night).size() == 3);
+    assert(byNight.weight == chains->edgeWeight(chains->findEdge(a, b, Profile::Night), Profile::Night));
+
+    // Coordinates snap only onto edges the profile may use: here the private
+    // driveway and the steps lie closest, the open footway ~11 m away
+    const std::string snapFile = (std::filesystem::temp_directory_path() / "testProfileSnap.geojson").string();
+    {
+        std::ofstream out(snapFile);
+        out << R"({"type": "FeatureCollection", "features": [
+            {"type": "Feature", "properties": {"access": "private"}, "geometry": {"type": "LineString",
+                "coordinates": [[-118.4400, 34.0700], [-118.4390, 34.0700]]}},
+            {"type": "Feature", "properties": {"highway": "steps"}, "geometry": {"type": "LineString",
+                "coordinates": [[-118.4400, 34.0701], [-118.4390, 34.0701]]}},
+            {"type": "Feature", "properties": {"highway": "footway"}, "geometry": {"type": "LineString",
+                "coordinates": [[-118.4400, 34.0702], [-118.4390, 34.0702]]}}
+        ]})";
+    }
+    auto snapping = Graph::fromFile(snapFile);
+    std::filesystem::remove(snapFile);
+    const Graph::Coordinate from{34.07001, -118.4398}, to{34.07001, -118.4392};
+    auto snappedLat = [&](Profile profile) { return snapping->nearestEdgePoint(from.lat, from.lon, profile).lat; };
+    assert(std::abs(snappedLat(Profile::Walking) - 34.0701) < 1e-9);
+    assert(std::abs(snappedLat(Profile::Wheelchair) - 34.0702) < 1e-9);
+    Dijkstra snapDijkstra(snapping);
+    for (Profile profile : {Profile::Walking, Profile::Wheelchair}) {
+        auto route = snapDijkstra.computePath(from, to, profile);
+        assert(route.reachable && std::isfinite(route.weight) && route.path.empty());
+    }
+
+    std::cout << "PASS: testRoutingProfiles\n";
+}
+
 int main() {
     // These tests assume:
     // - Graph parses data/ucla.geojson into nodes + edges
@@ -130,6 +1106,23 @@ int main() {
     testSameStartEnd();
     testInvalidNodeNames();
     testPathIsContinuousEdges();
+    testSharedGraph();
+    testBidirectionalEngines();
+    testContractionHierarchy();
+    testAltAstar();
+    testQueuePolicies();
+    testConcurrentQueries();
+    testBatchQueries();
+    testDistanceMatrix();
+    testOneToAll();
+    testSpatialIndex();
+    testEdgePointQueries();
+    testParallelEdgePoints();
+    testAstarHeuristics();
+    testGeoBatchKernels();
+    testComponentRejection();
+    testContractedChains();
+    testRoutingProfiles();
 
     std::cout << "ALL ROUTING TESTS PASSED\n";
     return 0;